@@ -1,2 +1,8 @@
-@rem wgfs-packer will overwrite the asset file if it exists
-wgfs-packer assets assets.json
\ No newline at end of file
+@rem bake the glyphs the game draws, the runtime then skips freetype entirely (sizes match FONT_MENU_SIZE/FONT_HELP_SIZE)
+fontbake assets/font.ttf assets/font.wbf --sizes 48,24 --strings assets.json --names assets --chars "1.0"
+
+@rem wgfs-packer (tools/wgfs-packer) will overwrite the asset file if it exists, same inputs give the same data.dat
+@rem .wgfs-cache keeps what every file turned into, only changed files get processed again
+@rem --ids regenerates the game's asset/string IDs to match the archive
+@rem --fit scales the sprites to the box the game shows them in (SPRITE_FIT_W/SPRITE_FIT_H), so loading them scales nothing
+wgfs-packer assets assets.json data.dat --pixels --fit 1280x640 --cache .wgfs-cache --ids ../myproject/assetids.h
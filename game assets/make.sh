@@ -0,0 +1,14 @@
+#!/bin/sh
+# same as make.bat, with the tools built by `make -C tools`
+set -e
+cd "$(dirname "$0")"
+BIN=../tools/bin
+
+# bake the glyphs the game draws, the runtime then skips freetype entirely (sizes match FONT_MENU_SIZE/FONT_HELP_SIZE)
+$BIN/fontbake assets/font.ttf assets/font.wbf --sizes 48,24 --strings assets.json --names assets --chars "1.0"
+
+# wgfs-packer will overwrite the asset file if it exists, same inputs give the same data.dat
+# .wgfs-cache keeps what every file turned into, only changed files get processed again
+# --ids regenerates the game's asset/string IDs to match the archive
+# --fit scales the sprites to the box the game shows them in (SPRITE_FIT_W/SPRITE_FIT_H), so loading them scales nothing
+$BIN/wgfs-packer assets assets.json data.dat --pixels --fit 1280x640 --cache .wgfs-cache --ids ../myproject/assetids.h
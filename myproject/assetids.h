@@ -0,0 +1,67 @@
+// Generated by wgfs-packer --ids from assets.json and the asset directory, don't edit.
+// Indices match the data.dat packed with it, Assets::GetFileById/GetString fall back to
+// the name when they don't.
+#ifndef _ASSETIDS_H_
+#define _ASSETIDS_H_
+
+#include "wgfsformat.h"
+
+namespace AssetIds
+{
+	namespace Files
+	{
+		constexpr uint32_t FILE_COUNT = 13;
+
+		constexpr WGFS::AssetId BANANA_PNG = { 0, 0x23840995, "banana.png" };
+		constexpr WGFS::AssetId CAT_PNG = { 1, 0xEDD46E4E, "cat.png" };
+		constexpr WGFS::AssetId FLASHDRIVE_PNG = { 2, 0xFD9F4CFA, "flashdrive.png" };
+		constexpr WGFS::AssetId FONT_TTF = { 3, 0x69A71E94, "font.ttf" };
+		constexpr WGFS::AssetId FONT_WBF = { 4, 0xDF293D6B, "font.wbf" };
+		constexpr WGFS::AssetId FOX_PNG = { 5, 0x2D6808E7, "fox.png" };
+		constexpr WGFS::AssetId IDIOT_PNG = { 6, 0xCBB0B1ED, "idiot.png" };
+		constexpr WGFS::AssetId MIRROR_PNG = { 7, 0xACE965C3, "mirror.png" };
+		constexpr WGFS::AssetId OPOSSUM_PNG = { 8, 0xE2393C9E, "opossum.png" };
+		constexpr WGFS::AssetId PEN_PNG = { 9, 0x95CE1235, "pen.png" };
+		constexpr WGFS::AssetId PUG_PNG = { 10, 0x8E6FCD8A, "pug.png" };
+		constexpr WGFS::AssetId RAT_PNG = { 11, 0x6063479D, "rat.png" };
+		constexpr WGFS::AssetId ROUTER_PNG = { 12, 0xC6D52B71, "router.png" };
+
+		constexpr WGFS::AssetId ALL[] = {
+			BANANA_PNG, CAT_PNG, FLASHDRIVE_PNG, FONT_TTF,
+			FONT_WBF, FOX_PNG, IDIOT_PNG, MIRROR_PNG,
+			OPOSSUM_PNG, PEN_PNG, PUG_PNG, RAT_PNG,
+			ROUTER_PNG,
+		};
+	}
+
+	namespace Strings
+	{
+		constexpr uint32_t STRING_COUNT = 16;
+
+		constexpr WGFS::AssetId TITLE = { 0, 0x9865B509, "title" };
+		constexpr WGFS::AssetId UNDER_TITLE = { 1, 0xD88B4620, "under_title" };
+		constexpr WGFS::AssetId START_TEXT = { 2, 0x5E3661B7, "start_text" };
+		constexpr WGFS::AssetId QUESTION_FORMAT = { 3, 0xFB873E1D, "question_format" };
+		constexpr WGFS::AssetId QUESTION_ALTVERB_FORMAT = { 4, 0x5B7B436A, "question_altverb_format" };
+		constexpr WGFS::AssetId UNDER_PICTURE = { 5, 0x920D5FBC, "under_picture" };
+		constexpr WGFS::AssetId HUD_TEXT = { 6, 0x73B73D6C, "hud_text" };
+		constexpr WGFS::AssetId LOST_TEXT = { 7, 0x22F32FAB, "lost_text" };
+		constexpr WGFS::AssetId IDIOT_PNG_TEXT = { 8, 0x8D8CCD6A, "idiot_png_text" };
+		constexpr WGFS::AssetId VERSION_TEXT = { 9, 0xE662403F, "version_text" };
+		constexpr WGFS::AssetId WOW_AN_EASTER_EGG = { 10, 0x0A5F2CDE, "wow an easter egg" };
+		constexpr WGFS::AssetId WOW_AN_EASTER_EGG_TWICE = { 11, 0xB316AC2A, "wow an easter egg twice" };
+		constexpr WGFS::AssetId WTF = { 12, 0x01AEC580, "wtf" };
+		constexpr WGFS::AssetId HEH = { 13, 0x0EB4B67A, "heh" };
+		constexpr WGFS::AssetId DESC = { 14, 0x83030020, "desc" };
+		constexpr WGFS::AssetId DER_MANN = { 15, 0x72B01A2E, "DER MANN" };
+
+		constexpr WGFS::AssetId ALL[] = {
+			TITLE, UNDER_TITLE, START_TEXT, QUESTION_FORMAT,
+			QUESTION_ALTVERB_FORMAT, UNDER_PICTURE, HUD_TEXT, LOST_TEXT,
+			IDIOT_PNG_TEXT, VERSION_TEXT, WOW_AN_EASTER_EGG, WOW_AN_EASTER_EGG_TWICE,
+			WTF, HEH, DESC, DER_MANN,
+		};
+	}
+}
+
+#endif // _ASSETIDS_H_
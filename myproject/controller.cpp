@@ -1,5 +1,5 @@
 #include "controller.h"
-#include "../../_common/log.h"
+#include "log.h"
 
 Controller::Controller()
 {
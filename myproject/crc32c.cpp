@@ -0,0 +1,72 @@
+#include <string.h>
+
+#include "crc32c.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <cpuid.h>
+#include <nmmintrin.h>
+#define CRC32C_SSE42
+#endif
+
+namespace CRC32C
+{
+	// reflected 0x1EDC6F41.
+	static const uint32_t POLY = 0x82F63B78;
+
+	static uint32_t Table[256];
+
+	static bool MakeTable()
+	{
+		for (uint32_t i = 0; i < 256; i++) {
+			uint32_t c = i;
+			for (int k = 0; k < 8; k++) c = (c >> 1) ^ (POLY & (0 - (c & 1)));
+			Table[i] = c;
+		}
+		return true;
+	}
+
+	static uint32_t UpdateTable(uint32_t crc, const uint8_t* p, size_t size)
+	{
+		static bool ready = MakeTable();
+		(void)ready;
+
+		for (size_t i = 0; i < size; i++) crc = Table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+		return crc;
+	}
+
+#ifdef CRC32C_SSE42
+	// only this function is built for SSE4.2, so the rest still runs on any x86-64.
+	__attribute__((target("sse4.2")))
+	static uint32_t UpdateSSE42(uint32_t crc, const uint8_t* p, size_t size)
+	{
+		uint64_t c = crc;
+		for (; size >= 8; p += 8, size -= 8) {
+			uint64_t w;
+			memcpy(&w, p, 8);
+			c = _mm_crc32_u64(c, w);
+		}
+
+		uint32_t c32 = (uint32_t)c;
+		for (; size > 0; p++, size--) c32 = _mm_crc32_u8(c32, *p);
+		return c32;
+	}
+
+	static bool HasSSE42()
+	{
+		unsigned int eax, ebx, ecx, edx;
+		return __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_SSE4_2) != 0;
+	}
+#endif
+
+	uint32_t Update(uint32_t crc, const uint8_t* data, size_t size)
+	{
+		crc = ~crc;
+
+#ifdef CRC32C_SSE42
+		static const bool sse42 = HasSSE42();
+		if (sse42) return ~UpdateSSE42(crc, data, size);
+#endif
+
+		return ~UpdateTable(crc, data, size);
+	}
+}
@@ -0,0 +1,20 @@
+#ifndef _CRC32C_H_
+#define _CRC32C_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+// CRC-32C (Castagnoli), the one SSE4.2's crc32 instruction computes. Uses the instruction when
+// the CPU has it (the PS4's always does), a table otherwise, both give the same values.
+namespace CRC32C
+{
+	// continues crc over size more bytes, start with 0.
+	uint32_t Update(uint32_t crc, const uint8_t* data, size_t size);
+
+	inline uint32_t Compute(const uint8_t* data, size_t size)
+	{
+		return Update(0, data, size);
+	}
+}
+
+#endif // _CRC32C_H_
@@ -0,0 +1,574 @@
+#include <string.h>
+#include <thread>
+
+#include "font.h"
+#include "log.h"
+
+#include FT_SIZES_H
+#include FT_STROKER_H
+#include FT_GLYPH_H
+
+static uint32_t ReadU32(const unsigned char *p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t ReadU16(const unsigned char *p)
+{
+	return p[0] | (p[1] << 8);
+}
+
+int Font::OutlineRadius(int pixelSize)
+{
+	return pixelSize / 16 > 1 ? pixelSize / 16 : 1;
+}
+
+int Font::ShadowOffset(int pixelSize)
+{
+	return pixelSize / 24 > 1 ? pixelSize / 24 : 1;
+}
+
+void Font::ComposeEffect(const Glyph *plain, TextEffect effect, int pixelSize, Glyph *out, std::unique_ptr<uint8_t[]> *pixels)
+{
+	// outlines grow on every side, shadows only down and to the right.
+	int grow = (effect == TextEffect::OUTLINE) ? OutlineRadius(pixelSize) : ShadowOffset(pixelSize);
+	int pad = (effect == TextEffect::OUTLINE) ? grow : 0;
+
+	out->w = plain->w + grow + pad;
+	out->h = plain->h + grow + pad;
+	out->pitch = out->w;
+	out->left = plain->left - pad;
+	out->top = plain->top + pad;
+	out->advance = plain->advance;
+
+	size_t plane = (size_t)out->w * out->h;
+	pixels->reset(new uint8_t[plane * 2 + 1]());
+
+	uint8_t *fill = pixels->get();
+	uint8_t *fx = fill + plane;
+
+	for (int y = 0; y < plain->h; y++)
+		memcpy(fill + ((y + pad) * out->pitch) + pad, plain->bitmap + (y * plain->pitch), plain->w);
+
+	if (effect == TextEffect::SHADOW) {
+		for (int y = 0; y < plain->h; y++)
+			memcpy(fx + ((y + grow) * out->pitch) + grow, plain->bitmap + (y * plain->pitch), plain->w);
+	}
+	else {
+		// round dilation of the coverage, only done once per glyph so the naive loop is fine.
+		for (int y = 0; y < plain->h; y++) {
+			for (int x = 0; x < plain->w; x++) {
+				uint8_t v = plain->bitmap[(y * plain->pitch) + x];
+				if (v == 0) continue;
+
+				for (int dy = -grow; dy <= grow; dy++) {
+					for (int dx = -grow; dx <= grow; dx++) {
+						if ((dx * dx) + (dy * dy) > (grow * grow) + grow) continue;
+
+						uint8_t *d = fx + ((y + pad + dy) * out->pitch) + (x + pad + dx);
+						if (*d < v) *d = v;
+					}
+				}
+			}
+		}
+	}
+
+	out->bitmap = fill;
+	out->effect = fx;
+}
+
+bool BakedFont::Load(size_t size, const unsigned char *blob)
+{
+	this->sizes.clear();
+
+	if (size < 12 || ReadU32(blob) != WBFN_HEADER) {
+		DEBUGLOG << "[FONT|ERROR]: Invalid WBFN header!";
+		return false;
+	}
+
+	uint32_t ver = ReadU32(blob + 4);
+	if (ver != WBFN_VERSION) {
+		DEBUGLOG << "[FONT|ERROR]: Unsupported WBFN version " << ver;
+		return false;
+	}
+
+	uint32_t sizeCount = ReadU32(blob + 8);
+	if (12 + (size_t)sizeCount * 32 > size) {
+		DEBUGLOG << "[FONT|ERROR]: Truncated size table!";
+		return false;
+	}
+
+	for (uint32_t i = 0; i < sizeCount; i++) {
+		const unsigned char *s = blob + 12 + i * 32;
+
+		auto bsPtr = std::make_unique<BakedSize>();
+		BakedSize &bs = *bsPtr;
+		bs.pixelSize = (int)ReadU32(s);
+		bs.lineHeight = (int)ReadU32(s + 4);
+		bs.ascender = (int)ReadU32(s + 8);
+
+		uint32_t glyphCount = ReadU32(s + 12);
+		uint32_t glyphOffset = ReadU32(s + 16);
+		uint32_t atlasWidth = ReadU32(s + 20);
+		uint32_t atlasHeight = ReadU32(s + 24);
+		uint32_t atlasOffset = ReadU32(s + 28);
+
+		if ((size_t)glyphOffset + (size_t)glyphCount * 20 > size ||
+			(size_t)atlasOffset + (size_t)atlasWidth * atlasHeight > size) {
+			DEBUGLOG << "[FONT|ERROR]: Size " << bs.pixelSize << " points outside of the blob!";
+			return false;
+		}
+
+		bs.atlas = blob + atlasOffset;
+		memset(bs.present, 0, sizeof(bs.present));
+		memset(bs.glyphs, 0, sizeof(bs.glyphs));
+		for (auto &cache : bs.effects)
+			memset(cache.state, 0, sizeof(cache.state));
+
+		for (uint32_t g = 0; g < glyphCount; g++) {
+			const unsigned char *e = blob + glyphOffset + g * 20;
+
+			uint32_t code = ReadU32(e);
+			if (code > 255) continue; // DrawText only ever asks for single bytes.
+
+			int x = ReadU16(e + 4);
+			int y = ReadU16(e + 6);
+
+			Glyph *gl = &bs.glyphs[code];
+			gl->w = ReadU16(e + 8);
+			gl->h = ReadU16(e + 10);
+			gl->left = (int16_t)ReadU16(e + 12);
+			gl->top = (int16_t)ReadU16(e + 14);
+			gl->advance = (int16_t)ReadU16(e + 16);
+			gl->pitch = (int)atlasWidth;
+			gl->bitmap = bs.atlas + (y * atlasWidth) + x;
+
+			if (x + gl->w > (int)atlasWidth || y + gl->h > (int)atlasHeight) {
+				DEBUGLOG << "[FONT|ERROR]: Glyph " << code << " lies outside of its atlas!";
+				continue;
+			}
+
+			bs.present[code] = true;
+		}
+
+		DEBUGLOG << "[FONT]: Baked size " << bs.pixelSize << " with " << glyphCount << " glyphs";
+		this->sizes.push_back(std::move(bsPtr));
+	}
+
+	return true;
+}
+
+BakedFont::BakedSize* BakedFont::FindSize(int pixelSize)
+{
+	for (auto &s : this->sizes) {
+		if (s->pixelSize == pixelSize) return s.get();
+	}
+
+	return nullptr;
+}
+
+bool BakedFont::Covers(const char *charset)
+{
+	for (auto &s : this->sizes) {
+		for (const char *c = charset; *c != '\0'; c++) {
+			unsigned char ch = (unsigned char)*c;
+			if (ch != '\n' && !s->present[ch]) {
+				DEBUGLOG << "[FONT]: '" << *c << "' wasn't baked at " << s->pixelSize;
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+bool BakedFont::HasSize(int pixelSize)
+{
+	return FindSize(pixelSize) != nullptr;
+}
+
+int BakedFont::GetLineHeight(int pixelSize)
+{
+	BakedSize *s = FindSize(pixelSize);
+	return s != nullptr ? s->lineHeight : 0;
+}
+
+const Glyph* BakedFont::GetGlyph(int pixelSize, unsigned char c, TextEffect effect)
+{
+	BakedSize *s = FindSize(pixelSize);
+	if (s == nullptr || !s->present[c]) return nullptr;
+
+	if (effect == TextEffect::NONE)
+		return &s->glyphs[c];
+
+	GlyphCache *cache = &s->effects[(int)effect];
+	if (cache->state[c] == GlyphState::UNKNOWN) {
+		ComposeEffect(&s->glyphs[c], effect, pixelSize, &cache->glyphs[c], &cache->pixels[c]);
+		cache->state[c] = GlyphState::PRESENT;
+	}
+
+	return &cache->glyphs[c];
+}
+
+int BakedFont::Prewarm(const char *charset, int threads)
+{
+	// the plain glyphs are already in the atlas, only the effects have to be built.
+	int made = 0;
+	for (auto &s : this->sizes) {
+		for (const char *c = charset; *c != '\0'; c++) {
+			unsigned char ch = (unsigned char)*c;
+			if (!s->present[ch]) continue;
+
+			for (int e = (int)TextEffect::NONE + 1; e < (int)TextEffect::COUNT; e++) {
+				if (s->effects[e].state[ch] != GlyphState::UNKNOWN) continue;
+
+				GetGlyph(s->pixelSize, ch, (TextEffect)e);
+				made++;
+			}
+		}
+	}
+
+	return made;
+}
+
+TTFont::TTFont()
+{
+	this->lib = nullptr;
+	this->face = nullptr;
+	this->stroker = nullptr;
+	this->fontBuf = nullptr;
+	this->fontBufSize = 0;
+}
+
+TTFont::~TTFont()
+{
+	// FT_Done_Face also drops every FT_Size created on it.
+	this->sizes.clear();
+
+	if (this->stroker != nullptr)
+		FT_Stroker_Done(this->stroker);
+
+	if (this->face != nullptr)
+		FT_Done_Face(this->face);
+}
+
+bool TTFont::Load(FT_Library lib, size_t bufSize, const unsigned char *fontBuf)
+{
+	int rc = FT_New_Memory_Face(lib, fontBuf, bufSize, 0, &this->face);
+
+	if (rc != 0) {
+		DEBUGLOG << "[FONT|ERROR]: FT_New_Memory_Face failed with " << rc;
+		this->face = nullptr;
+		return false;
+	}
+
+	// outlines are optional, plain text still works without a stroker.
+	if (FT_Stroker_New(lib, &this->stroker) != 0) {
+		DEBUGLOG << "[FONT|ERROR]: FT_Stroker_New failed, outlines fall back to plain glyphs";
+		this->stroker = nullptr;
+	}
+
+	this->lib = lib;
+	this->fontBuf = fontBuf;
+	this->fontBufSize = bufSize;
+	return true;
+}
+
+bool TTFont::AddSize(int pixelSize)
+{
+	if (this->face == nullptr) return false;
+	if (FindSize(pixelSize) != nullptr) return true;
+
+	auto s = std::make_unique<TTSize>();
+	s->pixelSize = pixelSize;
+	for (auto &cache : s->cache) {
+		memset(cache.state, 0, sizeof(cache.state));
+		memset(cache.glyphs, 0, sizeof(cache.glyphs));
+	}
+
+	if (FT_New_Size(this->face, &s->size) != 0) {
+		DEBUGLOG << "[FONT|ERROR]: FT_New_Size failed for size " << pixelSize;
+		return false;
+	}
+
+	FT_Activate_Size(s->size);
+
+	if (FT_Set_Pixel_Sizes(this->face, 0, pixelSize) != 0) {
+		DEBUGLOG << "[FONT|ERROR]: FT_Set_Pixel_Sizes failed for size " << pixelSize;
+		FT_Done_Size(s->size);
+		return false;
+	}
+
+	s->lineHeight = (int)(s->size->metrics.height >> 6);
+
+	DEBUGLOG << "[FONT]: Added size " << pixelSize;
+	this->sizes.push_back(std::move(s));
+	return true;
+}
+
+TTFont::TTSize* TTFont::FindSize(int pixelSize)
+{
+	for (auto &s : this->sizes) {
+		if (s->pixelSize == pixelSize) return s.get();
+	}
+
+	return nullptr;
+}
+
+bool TTFont::Rasterize(TTSize *s, unsigned char c, TextEffect effect)
+{
+	GlyphCache *cache = &s->cache[(int)effect];
+
+	switch (effect) {
+		case TextEffect::NONE: {
+			FT_Activate_Size(s->size);
+			return RenderGlyph(this->face, c, &cache->glyphs[c], &cache->pixels[c]);
+		}
+
+		case TextEffect::OUTLINE: {
+			if (this->stroker == nullptr) return false;
+
+			FT_Activate_Size(s->size);
+			FT_Stroker_Set(this->stroker, OutlineRadius(s->pixelSize) * 64, FT_STROKER_LINECAP_ROUND, FT_STROKER_LINEJOIN_ROUND, 0);
+			return RenderOutline(this->face, this->stroker, c, &cache->glyphs[c], &cache->pixels[c]);
+		}
+
+		default: {
+			const Glyph *plain = GetGlyph(s->pixelSize, c, TextEffect::NONE);
+			if (plain == nullptr) return false;
+
+			ComposeEffect(plain, effect, s->pixelSize, &cache->glyphs[c], &cache->pixels[c]);
+			return true;
+		}
+	}
+}
+
+bool TTFont::RenderGlyph(FT_Face face, unsigned char c, Glyph *g, std::unique_ptr<uint8_t[]> *pixels)
+{
+	FT_UInt glyph_index = FT_Get_Char_Index(face, c);
+
+	if (FT_Load_Glyph(face, glyph_index, FT_LOAD_DEFAULT) != 0)
+		return false;
+
+	if (FT_Render_Glyph(face->glyph, ft_render_mode_normal) != 0)
+		return false;
+
+	FT_GlyphSlot slot = face->glyph;
+
+	g->w = (int)slot->bitmap.width;
+	g->h = (int)slot->bitmap.rows;
+	g->pitch = g->w;
+	g->left = slot->bitmap_left;
+	g->top = slot->bitmap_top;
+	g->advance = (int)(slot->advance.x >> 6);
+
+	// the slot bitmap is overwritten by the next load, keep our own copy.
+	pixels->reset(new uint8_t[(size_t)g->w * g->h + 1]);
+	for (int row = 0; row < g->h; row++)
+		memcpy(pixels->get() + ((size_t)row * g->w), slot->bitmap.buffer + (row * slot->bitmap.pitch), g->w);
+
+	g->bitmap = pixels->get();
+	g->effect = nullptr;
+	return true;
+}
+
+bool TTFont::RenderOutline(FT_Face face, FT_Stroker stroker, unsigned char c, Glyph *g, std::unique_ptr<uint8_t[]> *pixels)
+{
+	FT_UInt glyph_index = FT_Get_Char_Index(face, c);
+
+	if (FT_Load_Glyph(face, glyph_index, FT_LOAD_DEFAULT) != 0)
+		return false;
+
+	// bitmap-only glyphs have nothing to stroke.
+	if (face->glyph->format != FT_GLYPH_FORMAT_OUTLINE)
+		return false;
+
+	int advance = (int)(face->glyph->advance.x >> 6);
+
+	FT_Glyph fill, border;
+	if (FT_Get_Glyph(face->glyph, &fill) != 0)
+		return false;
+
+	if (FT_Get_Glyph(face->glyph, &border) != 0) {
+		FT_Done_Glyph(fill);
+		return false;
+	}
+
+	bool ok =
+		FT_Glyph_StrokeBorder(&border, stroker, 0, 1) == 0 &&
+		FT_Glyph_To_Bitmap(&fill, FT_RENDER_MODE_NORMAL, nullptr, 1) == 0 &&
+		FT_Glyph_To_Bitmap(&border, FT_RENDER_MODE_NORMAL, nullptr, 1) == 0;
+
+	if (ok) {
+		FT_BitmapGlyph f = (FT_BitmapGlyph)fill;
+		FT_BitmapGlyph b = (FT_BitmapGlyph)border;
+
+		// one rectangle that holds both the fill and the stroke.
+		int x0 = f->left < b->left ? f->left : b->left;
+		int top = f->top > b->top ? f->top : b->top;
+		int x1 = f->left + (int)f->bitmap.width;
+		int y1 = (int)f->bitmap.rows - f->top;
+		if (x1 < b->left + (int)b->bitmap.width) x1 = b->left + (int)b->bitmap.width;
+		if (y1 < (int)b->bitmap.rows - b->top) y1 = (int)b->bitmap.rows - b->top;
+
+		g->w = x1 - x0;
+		g->h = y1 + top;
+		g->pitch = g->w;
+		g->left = x0;
+		g->top = top;
+		g->advance = advance;
+
+		size_t plane = (size_t)g->w * g->h;
+		pixels->reset(new uint8_t[plane * 2 + 1]());
+
+		FT_BitmapGlyph planes[2] = { f, b };
+		for (int p = 0; p < 2; p++) {
+			FT_Bitmap *bmp = &planes[p]->bitmap;
+			uint8_t *dst = pixels->get() + (p * plane) + ((top - planes[p]->top) * g->pitch) + (planes[p]->left - x0);
+
+			for (int row = 0; row < (int)bmp->rows; row++)
+				memcpy(dst + (row * g->pitch), bmp->buffer + (row * bmp->pitch), bmp->width);
+		}
+
+		g->bitmap = pixels->get();
+		g->effect = pixels->get() + plane;
+	}
+
+	FT_Done_Glyph(fill);
+	FT_Done_Glyph(border);
+	return ok;
+}
+
+bool TTFont::HasSize(int pixelSize)
+{
+	return FindSize(pixelSize) != nullptr;
+}
+
+int TTFont::GetLineHeight(int pixelSize)
+{
+	TTSize *s = FindSize(pixelSize);
+	return s != nullptr ? s->lineHeight : 0;
+}
+
+const Glyph* TTFont::GetGlyph(int pixelSize, unsigned char c, TextEffect effect)
+{
+	TTSize *s = FindSize(pixelSize);
+	if (s == nullptr) return nullptr;
+
+	GlyphCache *cache = &s->cache[(int)effect];
+	if (cache->state[c] == GlyphState::UNKNOWN)
+		cache->state[c] = Rasterize(s, c, effect) ? GlyphState::PRESENT : GlyphState::MISSING;
+
+	return cache->state[c] == GlyphState::PRESENT ? &cache->glyphs[c] : nullptr;
+}
+
+int TTFont::Prewarm(const char *charset, int threads)
+{
+	typedef struct _prewarm_job {
+		TTSize *s;
+		unsigned char c;
+		TextEffect effect;
+	} PrewarmJob;
+
+	// every (size, char, effect) that needs FreeType and isn't cached yet.
+	// shadows are made from the plain glyphs afterwards.
+	std::vector<PrewarmJob> jobs;
+	for (auto &s : this->sizes) {
+		for (TextEffect effect : { TextEffect::NONE, TextEffect::OUTLINE }) {
+			GlyphCache *cache = &s->cache[(int)effect];
+
+			for (const char *c = charset; *c != '\0'; c++) {
+				unsigned char ch = (unsigned char)*c;
+				if (ch != '\n' && cache->state[ch] == GlyphState::UNKNOWN) {
+					cache->state[ch] = GlyphState::MISSING; // claimed, also keeps duplicates in charset out.
+					jobs.push_back({ s.get(), ch, effect });
+				}
+			}
+		}
+	}
+
+	if (this->face == nullptr) return 0;
+	if (threads < 1) threads = 1;
+	if (threads > (int)jobs.size()) threads = jobs.empty() ? 1 : (int)jobs.size();
+
+	// faces and strokers are created and destroyed on this thread only, the library isn't safe to share for that.
+	std::vector<FT_Face> faces(threads, nullptr);
+	std::vector<FT_Stroker> strokers(threads, nullptr);
+	for (int i = 0; i < threads && !jobs.empty(); i++) {
+		if (FT_New_Memory_Face(this->lib, this->fontBuf, this->fontBufSize, 0, &faces[i]) != 0)
+			faces[i] = nullptr;
+
+		if (FT_Stroker_New(this->lib, &strokers[i]) != 0)
+			strokers[i] = nullptr;
+	}
+
+	// each worker owns every threads-th job, so no two workers write the same glyph slot.
+	auto worker = [&](int w) {
+		FT_Face face = faces[w];
+		FT_Stroker stroker = strokers[w];
+		int curSize = -1;
+
+		for (size_t j = w; j < jobs.size(); j += threads) {
+			PrewarmJob *job = &jobs[j];
+			GlyphCache *cache = &job->s->cache[(int)job->effect];
+			unsigned char c = job->c;
+
+			// no face (or stroker) for this worker, leave the glyph to be rasterised lazily.
+			if (face == nullptr || (job->effect == TextEffect::OUTLINE && stroker == nullptr)) {
+				cache->state[c] = GlyphState::UNKNOWN;
+				continue;
+			}
+
+			if (curSize != job->s->pixelSize) {
+				curSize = job->s->pixelSize;
+				FT_Set_Pixel_Sizes(face, 0, curSize);
+
+				if (stroker != nullptr)
+					FT_Stroker_Set(stroker, OutlineRadius(curSize) * 64, FT_STROKER_LINECAP_ROUND, FT_STROKER_LINEJOIN_ROUND, 0);
+			}
+
+			bool ok = (job->effect == TextEffect::OUTLINE) ?
+				RenderOutline(face, stroker, c, &cache->glyphs[c], &cache->pixels[c]) :
+				RenderGlyph(face, c, &cache->glyphs[c], &cache->pixels[c]);
+
+			if (ok)
+				cache->state[c] = GlyphState::PRESENT;
+		}
+	};
+
+	std::vector<std::thread> pool;
+	for (int i = 1; i < threads; i++)
+		pool.emplace_back(worker, i);
+
+	if (!jobs.empty())
+		worker(0);
+
+	for (auto &t : pool)
+		t.join();
+
+	for (int i = 0; i < threads; i++) {
+		if (strokers[i] != nullptr) FT_Stroker_Done(strokers[i]);
+		if (faces[i] != nullptr) FT_Done_Face(faces[i]);
+	}
+
+	// what a worker couldn't do without a face (or stroker) of its own is done here on the shared
+	// one, nothing else may touch the font yet. after this no glyph of charset is left to rasterise
+	// lazily, so laying out text off the main thread never goes into FreeType.
+	for (auto &job : jobs) {
+		if (job.s->cache[(int)job.effect].state[job.c] == GlyphState::UNKNOWN)
+			GetGlyph(job.s->pixelSize, job.c, job.effect);
+	}
+
+	int made = (int)jobs.size();
+	for (auto &s : this->sizes) {
+		for (const char *c = charset; *c != '\0'; c++) {
+			unsigned char ch = (unsigned char)*c;
+			if (ch == '\n' || s->cache[(int)TextEffect::SHADOW].state[ch] != GlyphState::UNKNOWN) continue;
+
+			GetGlyph(s->pixelSize, ch, TextEffect::SHADOW);
+			made++;
+		}
+	}
+
+	return made;
+}
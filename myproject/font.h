@@ -0,0 +1,145 @@
+#ifndef _FONT_H_
+#define _FONT_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <memory>
+#include <vector>
+#include <proto-include.h>
+
+// A single rasterised character. bitmap points at 8-bit coverage, rows are pitch bytes apart.
+// Glyphs with an effect also carry a second coverage plane of the same size for the outline/shadow.
+typedef struct _font_glyph {
+	const uint8_t *bitmap;
+	const uint8_t *effect; // nullptr for plain glyphs
+	int pitch;
+	int w;
+	int h;
+	int left;    // offset from the pen position to the left edge
+	int top;     // offset from the baseline to the top edge
+	int advance; // pen advance in pixels
+} Glyph;
+
+enum class TextEffect : int {
+	NONE,
+	OUTLINE,
+	SHADOW,
+	COUNT
+};
+
+// Something that can hand out glyphs for a given pixel size.
+class Font {
+protected:
+	enum class GlyphState : uint8_t {
+		UNKNOWN,
+		PRESENT,
+		MISSING
+	};
+
+	// Glyphs we had to make ourselves, one per character.
+	typedef struct _glyph_cache {
+		GlyphState state[256];
+		Glyph glyphs[256];
+		std::unique_ptr<uint8_t[]> pixels[256];
+	} GlyphCache;
+
+	static int OutlineRadius(int pixelSize);
+	static int ShadowOffset(int pixelSize);
+
+	// Builds an effect glyph out of a plain one. Outlines made this way are a dilation of the
+	// coverage, fonts that can do better (TTFont) stroke the real outline instead.
+	static void ComposeEffect(const Glyph *plain, TextEffect effect, int pixelSize, Glyph *out, std::unique_ptr<uint8_t[]> *pixels);
+
+public:
+	virtual ~Font() { }
+
+	virtual bool HasSize(int pixelSize) = 0;
+	virtual int GetLineHeight(int pixelSize) = 0;
+	virtual const Glyph* GetGlyph(int pixelSize, unsigned char c, TextEffect effect) = 0;
+
+	// Get every glyph of charset ready for every size and effect ahead of time, returns how many had
+	// to be rasterised. Nothing else may touch the font while this runs, afterwards those glyphs
+	// are only ever read, from any thread.
+	virtual int Prewarm(const char *charset, int threads) = 0;
+};
+
+// WBFN - Weird Bitmap FoNt
+// Glyphs pre-rasterised by tools/fontbake, drawn without ever touching FreeType.
+//
+// Layout (all little-endian):
+//   u32 magic, u32 version, u32 sizeCount
+//   sizeCount * { u32 pixelSize, i32 lineHeight, i32 ascender, u32 glyphCount,
+//                 u32 glyphOffset, u32 atlasWidth, u32 atlasHeight, u32 atlasOffset }
+//   glyphCount * { u32 charCode, u16 x, u16 y, u16 w, u16 h, i16 left, i16 top, i16 advance, u16 pad }
+//   8-bit coverage atlases, atlasWidth bytes per row.
+// Offsets are relative to the start of the blob.
+class BakedFont : public Font {
+	const uint32_t WBFN_HEADER = 1313227351;
+	const uint32_t WBFN_VERSION = 1;
+
+	typedef struct _baked_size {
+		int pixelSize;
+		int lineHeight;
+		int ascender;
+		const uint8_t *atlas;
+		bool present[256];
+		Glyph glyphs[256];
+		GlyphCache effects[(int)TextEffect::COUNT]; // NONE stays unused, those live in the atlas
+	} BakedSize;
+
+	std::vector<std::unique_ptr<BakedSize>> sizes;
+
+	BakedSize* FindSize(int pixelSize);
+
+public:
+	bool Load(size_t size, const unsigned char *blob);
+	// true when every character of charset was baked at every size. a language pack can bring
+	// characters the bake never saw, those would draw as nothing.
+	bool Covers(const char *charset);
+
+	bool HasSize(int pixelSize) override;
+	int GetLineHeight(int pixelSize) override;
+	const Glyph* GetGlyph(int pixelSize, unsigned char c, TextEffect effect) override;
+
+	int Prewarm(const char *charset, int threads) override;
+};
+
+// A TTF opened once, every pixel size gets its own FT_Size on the shared face.
+// Glyphs are rasterised on first use and cached per size and effect, so drawing
+// the same text again never goes back into FreeType.
+class TTFont : public Font {
+	typedef struct _tt_size {
+		int pixelSize;
+		int lineHeight;
+		FT_Size size;
+		GlyphCache cache[(int)TextEffect::COUNT];
+	} TTSize;
+
+	FT_Library lib;
+	FT_Face face;
+	FT_Stroker stroker;
+	const unsigned char *fontBuf;
+	size_t fontBufSize;
+	std::vector<std::unique_ptr<TTSize>> sizes;
+
+	TTSize* FindSize(int pixelSize);
+	bool Rasterize(TTSize *s, unsigned char c, TextEffect effect);
+	static bool RenderGlyph(FT_Face face, unsigned char c, Glyph *g, std::unique_ptr<uint8_t[]> *pixels);
+	static bool RenderOutline(FT_Face face, FT_Stroker stroker, unsigned char c, Glyph *g, std::unique_ptr<uint8_t[]> *pixels);
+
+public:
+	TTFont();
+	~TTFont();
+
+	bool Load(FT_Library lib, size_t bufSize, const unsigned char *fontBuf);
+	bool AddSize(int pixelSize);
+
+	bool HasSize(int pixelSize) override;
+	int GetLineHeight(int pixelSize) override;
+	const Glyph* GetGlyph(int pixelSize, unsigned char c, TextEffect effect) override;
+
+	// FT_Face isn't thread safe, so every worker rasterises on a face (and stroker) of its own.
+	int Prewarm(const char *charset, int threads) override;
+};
+
+#endif // _FONT_H_
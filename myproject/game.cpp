@@ -1,11 +1,11 @@
 #include <stdint.h>
 #include "controller.h"
-#include "../../_common/graphics.h"
-#include "../../_common/log.h"
+#include "graphics.h"
+#include "log.h"
 #include "game.h"
 #include <time.h>
-#include <list>
 #include <cctype>
+#include <atomic>
 
 #include <orbis/AudioOut.h>
 #define PARAMS16 ORBIS_AUDIO_OUT_PARAM_FORMAT_S16_STEREO
@@ -18,8 +18,32 @@
 #define FONT_MENU_SIZE 48 /* default font used in the menu */
 #define FONT_HELP_SIZE 24 /* a small font for tips & helps */
 
+// pixel sizes indexed by FONT_MENU/FONT_HELP, tools/fontbake must bake these.
+static const int FontSizes[] = { FONT_MENU_SIZE, FONT_HELP_SIZE };
+
 #define GAME_VERSION "1.0"
 
+#define FONT_PREWARM_THREADS 4 /* workers rasterising glyphs during Load */
+#define LOADER_THREADS 4 /* background threads decoding sprites, audio and glyphs */
+#define SPRITE_CACHE_BUDGET (48 * 1024 * 1024) /* bytes of decoded sprites kept around */
+#define SPRITE_FIT_W 1280 /* sprites are scaled to fit this box, so the question and the answer text */
+#define SPRITE_FIT_H 640  /* always have room. the packer does it (make.sh --fit), loading only catches packs that weren't */
+
+#define GAME_ASSET_BASE "/app0/assets/data.dat"
+
+// mounted over the base in this order when they exist: one shipped with a patch pkg, then one
+// dropped into /data for trying out content without a new pkg. that one can be any size, so only
+// its tables are read up front.
+typedef struct _game_asset_pack {
+	const char* path;
+	WGFS::Storage storage;
+} GameAssetPack;
+
+static const GameAssetPack GameAssetPacks[] = {
+	{ "/app0/assets/patch.dat", WGFS::Storage::MAPPED },
+	{ "/data/is-it-or-isnt/patch.dat", WGFS::Storage::STREAMED }
+};
+
 const char* Game::ToString(GameHAlign v) {
 	switch (v) {
 		case GameHAlign::CENTER: return "CENTER";
@@ -40,9 +64,11 @@ const char* Game::ToString(GameVAlign v) {
 
 const char* Game::ToString(GameState v) {
 	switch (v) {
+		case GameState::LOADING: return "LOADING";
 		case GameState::MENU: return "MENU";
 		case GameState::LOST: return "LOST";
 		case GameState::PLAY: return "PLAY";
+		case GameState::FAILED: return "FAILED";
 		default: return "[UNKNOWN]";
 	}
 }
@@ -56,10 +82,8 @@ void Game::SetObjects(Controller* const& c, Scene2D* const& sc) {
 	this->scene = sc;
 }
 
-void Game::DrawTextAlign(GameHAlign ha, GameVAlign va, char* string, int fontIndex, int x, int y, Color col, TextDimm *out) {
-	TextDimm myDimm = { 0, 0 };
-	FT_Face font = *(this->fonts[fontIndex]);
-	this->scene->CalcTextDimm(string, font, &myDimm);
+void Game::DrawTextAlign(GameHAlign ha, GameVAlign va, TextRun* run, int x, int y, Color col, TextDimm *out, Color fxCol) {
+	TextDimm myDimm = run->GetDimm();
 
 	switch (ha) {
 		case GameHAlign::CENTER: {
@@ -95,8 +119,7 @@ void Game::DrawTextAlign(GameHAlign ha, GameVAlign va, char* string, int fontInd
 		}
 	}
 
-	// always assume black background color because I am lazy.
-	this->scene->DrawText(string, font, x, y, { 0, 0, 0 }, col);
+	run->Draw(this->scene, x, y, col, fxCol);
 
 	if (out != nullptr) {
 		out->w = myDimm.w;
@@ -105,9 +128,9 @@ void Game::DrawTextAlign(GameHAlign ha, GameVAlign va, char* string, int fontInd
 }
 
 void Game::DrawSpriteAlign(GameHAlign ha, GameVAlign va, int sprite, int x, int y, PNG_INFO* out) {
-	auto spr = this->sprites[sprite];
+	auto spr = this->sprites.Get(sprite);
 	PNG_INFO info = { 0, 0, 0 };
-	spr->GetInfo(&info);
+	if (spr != nullptr) spr->GetInfo(&info);
 
 	switch (ha) {
 		case GameHAlign::LEFT: {
@@ -143,7 +166,7 @@ void Game::DrawSpriteAlign(GameHAlign ha, GameVAlign va, int sprite, int x, int
 		}
 	}
 
-	spr->Draw(this->scene, x, y);
+	if (spr != nullptr) spr->Draw(this->scene, x, y);
 
 	if (out != nullptr) {
 		out->w = info.w;
@@ -204,7 +227,8 @@ void Game::SimpleAudioThread() {
 }
 
 void Game::HandleAudio() {
-	if (this->SampleData != nullptr && !this->Playing) {
+	// the wav may still be decoding, then it starts on a later frame.
+	if (!this->Playing && IsReady(this->AudioReady) && this->AudioReady.get()) {
 		this->AudioThread = std::thread(&Game::SimpleAudioThread, this);
 		this->Playing = true;
 
@@ -238,47 +262,23 @@ void Game::ChangeState(GameState s) {
 
 			this->HandleAudio();
 
-			// the new sprite must not be equal to the current sprite!
-			// otherwise the game would be boring.
-			int oldSprite = this->PLAYimageindex;
-			do {
-				this->PLAYimageindex = (rand() % this->sprites.size());
-			} while (oldSprite == this->PLAYimageindex);
-
-			this->AnswerIsYes = RandomBool();
-
-			// question index is equal to our picture.
-			int qIndex = this->PLAYimageindex;
+			// normally it's been ready for a while, the first one may still be laying out.
+			if (!this->NextQuestionReady.valid()) this->PrepareNextQuestion();
+			this->NextQuestionReady.get();
 
-			// if the answer should be "No"
-			if (!this->AnswerIsYes) {
-				// find any other name that's not this file.
-				do {
-					qIndex = (rand() % this->sprites.size());
-				} while (qIndex == this->PLAYimageindex);
+			// a sprite that turns out not to decode gets swapped for another before it's shown.
+			while (this->sprites.Get(this->questions[1 - this->currentQuestion].sprite) == nullptr
+				&& this->sprites.GetCount() - this->sprites.GetBrokenCount() >= 2) {
+				this->PrepareNextQuestion();
+				this->NextQuestionReady.get();
 			}
 
-			DEBUGLOG <<
-				"playindex " << this->PLAYimageindex <<
-				" isyes " << this->ToString(this->AnswerIsYes) <<
-				" qindex " << qIndex;
+			this->currentQuestion = 1 - this->currentQuestion;
+			this->PLAYimageindex = this->questions[this->currentQuestion].sprite;
+			this->AnswerIsYes = this->questions[this->currentQuestion].answerIsYes;
 
-			std::string filename = this->lookup[qIndex];
-			filename = filename.substr(0, filename.find('.', 0));
-
-			DEBUGLOG << "filename " << filename;
-
-			if (IsAnVerb(filename)) // 'is an '
-				this->Question = this->strings[Si(GameStrings::QUESTION_ALTVERB_FORMAT)];
-			else // 'is a '
-				this->Question = this->strings[Si(GameStrings::QUESTION_FORMAT)];
-
-			char fmt_question[128] = { };
-			snprintf(fmt_question, sizeof(fmt_question), this->Question.c_str(), filename.c_str());
-
-			this->Question = fmt_question;
-
-			DEBUGLOG << "formatted question " << fmt_question;
+			// and straight away the one after this.
+			this->PrepareNextQuestion();
 
 			break;
 		}
@@ -294,13 +294,81 @@ void Game::ChangeState(GameState s) {
 	}
 }
 
+void Game::PrepareNextQuestion() {
+	GameQuestion* q = &this->questions[1 - this->currentQuestion];
+
+	// broken sprites never come up again, as long as there's something else to show.
+	bool skipBroken = this->sprites.GetCount() - this->sprites.GetBrokenCount() >= 2;
+
+	// the new sprite must not be equal to the current sprite!
+	// otherwise the game would be boring.
+	do {
+		q->sprite = (rand() % this->sprites.GetCount());
+	} while (q->sprite == this->PLAYimageindex || (skipBroken && this->sprites.IsBroken(q->sprite)));
+
+	q->answerIsYes = RandomBool();
+
+	// question index is equal to our picture.
+	int qIndex = q->sprite;
+
+	// if the answer should be "No"
+	if (!q->answerIsYes) {
+		// find any other name that's not this file.
+		do {
+			qIndex = (rand() % this->sprites.GetCount());
+		} while (qIndex == q->sprite);
+	}
+
+	DEBUGLOG <<
+		"next playindex " << q->sprite <<
+		" isyes " << this->ToString(q->answerIsYes) <<
+		" qindex " << qIndex;
+
+	// the picture decodes on the loader while this one is up.
+	this->sprites.Request(q->sprite);
+
+	// so does the layout. every glyph it can touch was prewarmed, so the font is only read.
+	const std::string* filename = &this->lookup[qIndex];
+	this->NextQuestionReady = this->loader.Submit<bool>([this, q, filename]() {
+		// the name without its extension goes straight into the question, no copies.
+		size_t nameLen = filename->find('.', 0);
+		if (nameLen == std::string::npos) nameLen = filename->size();
+
+		if (IsAnVerb(*filename)) // 'is an '
+			q->text.Format(this->questionAltFormat, filename->c_str(), nameLen);
+		else // 'is a '
+			q->text.Format(this->questionFormat, filename->c_str(), nameLen);
+
+		return true;
+	});
+}
+
+void Game::StateLoading() {
+	// no text in here, the font belongs to the prewarm until it's done.
+	int total = this->loader.GetSubmitted();
+	int done = this->loader.GetFinished();
+
+	int barW = FRAME_WIDTH / 2;
+	int barH = 16;
+	int barX = (FRAME_WIDTH - barW) / 2;
+	int barY = (FRAME_HEIGHT - barH) / 2;
+
+	this->scene->DrawRectangle(barX, barY, barW, barH, { 64, 64, 64 });
+	if (total > 0) this->scene->DrawRectangle(barX, barY, (barW * done) / total, barH, { 255, 255, 255 });
+
+	// the menu is only text, the wav can keep loading behind it.
+	if (IsReady(this->GlyphsReady)) {
+		this->InitText();
+		this->PrepareNextQuestion(); // the first question gets ready while the menu is up
+		DEBUGLOG << "menu ready after " << (sceKernelGetProcessTime() - this->LoadStart) << "us, " << done << "/" << total << " loads done, archive resident " << this->assets->GetResidentBytes() << " bytes";
+		this->ChangeState(GameState::MENU);
+	}
+}
+
 void Game::StateMenu() {
 	Color white = { 255, 255, 255 };
 
 	// title text.
-	char* titleString = (char*)this->strings[Si(GameStrings::TITLE)].c_str();
-	char* underString = (char*)this->strings[Si(GameStrings::UNDER_TITLE)].c_str();
-	char* startString = (char*)this->strings[Si(GameStrings::START_TEXT)].c_str();
 	int titleMargin = FONT_MENU_SIZE;
 	int centerX = FRAME_WIDTH / 2;
 	int centerY = FRAME_HEIGHT / 2;
@@ -310,15 +378,12 @@ void Game::StateMenu() {
 
 	TextDimm dimm = { 0, 0 };
 
-	this->DrawTextAlign(h, v, titleString, FONT_MENU, centerX, centerY - titleMargin, white, &dimm);
-	this->DrawTextAlign(h, v, underString, FONT_HELP, centerX, centerY - titleMargin + dimm.h, white, nullptr);
+	this->DrawTextAlign(h, v, &this->titleText, centerX, centerY - titleMargin, white, &dimm);
+	this->DrawTextAlign(h, v, &this->underTitleText, centerX, centerY - titleMargin + dimm.h, white, nullptr);
 
-	this->DrawTextAlign(h, v, startString, FONT_MENU, centerX, centerY + (titleMargin * 4), white, nullptr);
+	this->DrawTextAlign(h, v, &this->startText, centerX, centerY + (titleMargin * 4), white, nullptr);
 
-	char versionString[128] = { };
-	snprintf(versionString, sizeof(versionString), this->strings[Si(GameStrings::VERSION_TEXT)].c_str(), GAME_VERSION);
-
-	this->DrawTextAlign(GameHAlign::LEFT, GameVAlign::TOP, versionString, FONT_HELP, 64, 64, white, nullptr);
+	this->DrawTextAlign(GameHAlign::LEFT, GameVAlign::TOP, &this->versionText, 64, 64, white, nullptr);
 
 	/*
 	this->scene->DrawText((char*)(std::string("Halign: ") + std::string(this->ToString(this->hal))).c_str(), *this->fonts[0], 64, 64, black, white);
@@ -339,19 +404,18 @@ void Game::StatePlay() {
 	int centerY = FRAME_HEIGHT / 2;
 	int margin = FONT_MENU_SIZE;
 
-	PNG_INFO pI = { 0, 0, 0 };
+	this->HandleAudio();
 
-	char* underPicture = (char*)this->strings[Si(GameStrings::UNDER_PICTURE)].c_str();
+	PNG_INFO pI = { 0, 0, 0 };
 
 	this->DrawSpriteAlign(GameHAlign::CENTER, GameVAlign::MIDDLE, this->PLAYimageindex, centerX, centerY, &pI);
 
-	this->DrawTextAlign(GameHAlign::CENTER, GameVAlign::BOTTOM, (char*)this->Question.c_str(), FONT_MENU, centerX, centerY - (pI.h / 2) - margin/2, white, nullptr);
-	this->DrawTextAlign(GameHAlign::CENTER, GameVAlign::TOP, underPicture, FONT_MENU, centerX, centerY + (pI.h / 2) + margin, white, nullptr);
+	this->DrawTextAlign(GameHAlign::CENTER, GameVAlign::BOTTOM, &this->questions[this->currentQuestion].text, centerX, centerY - (pI.h / 2) - margin/2, white, nullptr);
+	this->DrawTextAlign(GameHAlign::CENTER, GameVAlign::TOP, &this->underPictureText, centerX, centerY + (pI.h / 2) + margin, white, nullptr);
 
-	char scorestr[128] = { };
-	snprintf(scorestr, sizeof(scorestr), this->strings[Si(GameStrings::HUD_TEXT)].c_str(), this->Score);
-
-	this->DrawTextAlign(GameHAlign::LEFT, GameVAlign::TOP, scorestr, FONT_MENU, 64, 64, white, nullptr);
+	// only lays out again when the score actually changed.
+	this->scoreText.Format(this->hudFormat, this->Score);
+	this->DrawTextAlign(GameHAlign::LEFT, GameVAlign::TOP, &this->scoreText, 64, 64, white, nullptr);
 
 	int input = this->con->CheckButtonPressed(ORBIS_PAD_BUTTON_CROSS) - this->con->CheckButtonPressed(ORBIS_PAD_BUTTON_CIRCLE);
 	if (input != 0) {
@@ -374,25 +438,20 @@ void Game::StatePlay() {
 }
 
 void Game::StateLost() {
-	char* lostString = (char*)this->strings[Si(GameStrings::LOST_TEXT)].c_str();
 	Color white = { 255, 255, 255 };
 
 	int lostX = FRAME_WIDTH / 2;
 	int lostY = (FRAME_HEIGHT / 2) - FONT_MENU_SIZE;
 	int scoreY = (FRAME_HEIGHT / 2) + FONT_MENU_SIZE;
-	this->DrawTextAlign(GameHAlign::CENTER, GameVAlign::BOTTOM, lostString, FONT_MENU, lostX, lostY, white, nullptr);
-
-	char scorestr[128] = { };
-	snprintf(scorestr, sizeof(scorestr), this->strings[Si(GameStrings::HUD_TEXT)].c_str(), this->Score);
-
-	this->DrawTextAlign(GameHAlign::CENTER, GameVAlign::TOP, scorestr, FONT_MENU, lostX, scoreY, white, nullptr);
+	this->DrawTextAlign(GameHAlign::CENTER, GameVAlign::BOTTOM, &this->lostText, lostX, lostY, white, nullptr);
 
-	if (strcmp(this->lookup[this->PLAYimageindex].c_str(), "idiot.png") == 0) {
-		char* nGonIsAnIdiot = (char*)this->strings[Si(GameStrings::IDIOT_PNG_TEXT)].c_str();
+	this->scoreText.Format(this->hudFormat, this->Score);
+	this->DrawTextAlign(GameHAlign::CENTER, GameVAlign::TOP, &this->scoreText, lostX, scoreY, white, nullptr);
 
+	if (strcmp(this->lookup[this->PLAYimageindex].c_str(), AssetIds::Files::IDIOT_PNG.name) == 0) {
 		//Color dkwhite = { 250, 250, 250 };
 
-		this->DrawTextAlign(GameHAlign::LEFT, GameVAlign::TOP, nGonIsAnIdiot, FONT_HELP, 64, 64, white, nullptr);
+		this->DrawTextAlign(GameHAlign::LEFT, GameVAlign::TOP, &this->idiotText, 64, 64, white, nullptr);
 	}
 
 	if (this->con->CheckButtonPressed(ORBIS_PAD_BUTTON_CROSS) || this->con->CheckButtonPressed(ORBIS_PAD_BUTTON_OPTIONS)) {
@@ -402,6 +461,42 @@ void Game::StateLost() {
 	}
 }
 
+void Game::StateFailed() {
+	// there may be no font to explain it with, the log says what went wrong.
+	this->scene->FrameBufferFill({ 128, 0, 0 });
+}
+
+void Game::InitText() {
+	Font* f = this->font.get();
+	if (f == nullptr) return;
+
+	this->questionFormat.Parse(this->strings[AssetIds::Strings::QUESTION_FORMAT.index]);
+	this->questionAltFormat.Parse(this->strings[AssetIds::Strings::QUESTION_ALTVERB_FORMAT.index]);
+	this->hudFormat.Parse(this->strings[AssetIds::Strings::HUD_TEXT.index]);
+	this->versionFormat.Parse(this->strings[AssetIds::Strings::VERSION_TEXT.index]);
+
+	this->titleText.Init(f, FontSizes[FONT_MENU]);
+	this->underTitleText.Init(f, FontSizes[FONT_HELP]);
+	this->startText.Init(f, FontSizes[FONT_MENU]);
+	this->versionText.Init(f, FontSizes[FONT_HELP]);
+	this->lostText.Init(f, FontSizes[FONT_MENU]);
+	this->idiotText.Init(f, FontSizes[FONT_HELP]);
+
+	// big pictures can reach the text, outline it so it stays readable.
+	this->questions[0].text.Init(f, FontSizes[FONT_MENU], TextEffect::OUTLINE);
+	this->questions[1].text.Init(f, FontSizes[FONT_MENU], TextEffect::OUTLINE);
+	this->underPictureText.Init(f, FontSizes[FONT_MENU], TextEffect::OUTLINE);
+	this->scoreText.Init(f, FontSizes[FONT_MENU], TextEffect::SHADOW);
+
+	this->titleText.SetText(this->strings[AssetIds::Strings::TITLE.index].data());
+	this->underTitleText.SetText(this->strings[AssetIds::Strings::UNDER_TITLE.index].data());
+	this->startText.SetText(this->strings[AssetIds::Strings::START_TEXT.index].data());
+	this->underPictureText.SetText(this->strings[AssetIds::Strings::UNDER_PICTURE.index].data());
+	this->lostText.SetText(this->strings[AssetIds::Strings::LOST_TEXT.index].data());
+	this->idiotText.SetText(this->strings[AssetIds::Strings::IDIOT_PNG_TEXT.index].data());
+	this->versionText.Format(this->versionFormat, GAME_VERSION, strlen(GAME_VERSION));
+}
+
 void Game::GameFrame() {
 
 	this->con->UpdateState(); // update the dualshock's state.
@@ -421,6 +516,11 @@ void Game::GameFrame() {
 
 	// process the current game state.
 	switch (this->state) {
+		case GameState::LOADING: {
+			StateLoading();
+			break;
+		}
+
 		case GameState::MENU: {
 			StateMenu();
 			break;
@@ -435,81 +535,179 @@ void Game::GameFrame() {
 			StateLost();
 			break;
 		}
+
+		case GameState::FAILED: {
+			StateFailed();
+			break;
+		}
 	}
 
 }
 
+void Game::LoadSprites(const std::vector<WGFS::AssetId>& ids) {
+	// nothing is decoded yet, that happens the first time a sprite gets picked.
+	this->sprites.Init(this->assets.get(), &this->loader, SPRITE_CACHE_BUDGET, SPRITE_FIT_W, SPRITE_FIT_H);
+
+	for (auto& id : ids) {
+		auto file = this->assets->GetFileById(id); // get the sprite's file struct
+		if (file == nullptr) continue;
+
+		this->lookup.push_back(id.name); // push the name of the sprite to a SPRITE|NAME look up table.
+		this->sprites.Add(file);
+	}
+}
+
+bool Game::LoadAudio() {
+	uint64_t t = sceKernelGetProcessTime();
+	auto sound = this->assets->GetFileByName("audio.wav"); // not every asset folder has one, so no ID
+
+	int err = sceAudioOutInit();
+	if (err != 0 || sound == nullptr) return false;
+
+	DEBUGLOG << "sceAudio init ok";
+
+	this->AudioHandle = sceAudioOutOpen(ORBIS_USER_SERVICE_USER_ID_SYSTEM, ORBIS_AUDIO_OUT_PORT_TYPE_MAIN, 0, 256, 48000, PARAMS16);
+
+	if (this->AudioHandle <= 0) {
+		DEBUGLOG << "sceAudioOut open fail";
+		return false;
+	}
+
+	if (!drwav_init_memory(&this->DrWav, this->assets->GetData(sound), sound->rawSize, NULL)) {
+		DEBUGLOG << "drwav init fail :(";
+		return false;
+	}
+
+	// Calculate the sample count and allocate a buffer for the sample data accordingly
+	size_t sampleCount = this->DrWav.totalPCMFrameCount * this->DrWav.channels;
+	this->SampleData = (drwav_int16 *)malloc(sampleCount * sizeof(drwav_int16));
+
+	// Decode the wav into pSampleData
+	drwav_read_pcm_frames_s16(&this->DrWav, this->DrWav.totalPCMFrameCount, this->SampleData);
+
+	this->SampleCount = sampleCount;
+
+	// it's all PCM now, the wav itself is never read again.
+	this->assets->Discard(sound);
+	DEBUGLOG << "archive resident after audio: " << this->assets->GetResidentBytes() << " of " << this->assets->GetArchiveSize() << " bytes";
+
+	DEBUGLOG << ".wav decoded and loaded in " << (sceKernelGetProcessTime() - t) << "us";
+	return true;
+}
+
 void Game::Load() {
 	// load sum assets here lol
 	DEBUGLOG << "Game::Load()!";
-	this->assets = std::make_unique<WGFS::Assets>();
-	this->assets->LoadFromFile("/app0/assets/data.dat");
+	this->LoadStart = sceKernelGetProcessTime();
+	this->assets = std::make_unique<WGFS::VFS>();
 
-	this->state = GameState::MENU;
+	// only the archive, the font and the strings are loaded here, everything else is queued up
+	// for the loader and the LOADING state shows how far it got.
+	this->state = GameState::LOADING;
 	this->Count = false;
 	this->PLAYimageindex = -1;
+	this->currentQuestion = 0;
+
+	this->AudioHandle = -1;
+	this->Playing = false;
+	this->SampleData = nullptr;
+
+	// packs only override the base, without it there's nothing to play.
+	if (!this->assets->Mount(GAME_ASSET_BASE)) {
+		DEBUGLOG << "[GAME|ERROR]: can't mount " << GAME_ASSET_BASE;
+		this->state = GameState::FAILED;
+		return;
+	}
+
+	// content updates and languages come as packs over the base, whatever they have wins.
+	for (const GameAssetPack& pack : GameAssetPacks) this->assets->Mount(pack.path, pack.storage);
+	DEBUGLOG << "archive resident after mount: " << this->assets->GetResidentBytes() << " of " << this->assets->GetArchiveSize() << " bytes";
 
 	unsigned int seed = ((unsigned int)(time(NULL) & UINT32_MAX))/* / 2U*/; // this is bad but it was 1 AM.
 	srand(seed);
 	DEBUGLOG << "srand seed " << seed;
 
-	DEBUGLOG << "init font!";
-	auto font = this->assets->GetFileByName("font.ttf");
-	this->fonts.push_back(this->assets->MakeFontFromFile(font, FONT_MENU_SIZE, this->scene));
-	this->fonts.push_back(this->assets->MakeFontFromFile(font, FONT_HELP_SIZE, this->scene));
-
 	DEBUGLOG << "init strings!";
-	std::list<std::string> stringids{ "title", "under_title", "start_text", "question_format", "question_altverb_format", "under_picture", "hud_text", "lost_text", "idiot_png_text", "version_text" };
-	
-	for (auto& name : stringids) {
-		DEBUGLOG << "loading string " << name;
-		this->strings.push_back(this->assets->GetString(name));
+	// every string in the archive, indexed by AssetIds::Strings.
+	for (auto& id : AssetIds::Strings::ALL) {
+		DEBUGLOG << "loading string " << id.name;
+		std::string_view str = this->assets->GetString(id);
+		this->strings.push_back(str.data() != nullptr ? str : std::string_view("")); // a missing one still has to draw
 	}
 
-	DEBUGLOG << "init sprites!";
-	std::list<std::string> spritenames{ "banana.png", "cat.png", "idiot.png", "pug.png", "router.png", "opossum.png", "rat.png", "mirror.png", "fox.png", "pen.png", "flashdrive.png" };
-
-	for (auto& name : spritenames) {
-		DEBUGLOG << "loading sprite " << name;
-		auto file = this->assets->GetFileByName(name.c_str()); // get the sprite's file struct
-		if (file == nullptr) continue;
+	// a sprite that's gone from the assets fails the build here instead of going missing in game.
+	std::vector<WGFS::AssetId> spriteids{
+		AssetIds::Files::BANANA_PNG, AssetIds::Files::CAT_PNG, AssetIds::Files::IDIOT_PNG, AssetIds::Files::PUG_PNG,
+		AssetIds::Files::ROUTER_PNG, AssetIds::Files::OPOSSUM_PNG, AssetIds::Files::RAT_PNG, AssetIds::Files::MIRROR_PNG,
+		AssetIds::Files::FOX_PNG, AssetIds::Files::PEN_PNG, AssetIds::Files::FLASHDRIVE_PNG
+	};
+
+	// everything we can ever draw: the string table, the sprite names (they end up in questions),
+	// the score digits and the version. rasterise all of it in the background.
+	bool used[256] = { };
+	for (const char* c = "0123456789" GAME_VERSION; *c; c++) used[(unsigned char)*c] = true;
+	for (auto& str : this->strings) for (unsigned char c : str) used[c] = true;
+	for (auto& id : spriteids) for (const char* c = id.name; *c; c++) used[(unsigned char)*c] = true;
+
+	std::string charset;
+	for (int c = 1; c < 256; c++) {
+		if (used[c]) charset.push_back((char)c);
+	}
 
-		this->lookup.push_back(name); // push the name of the sprite to a SPRITE|NAME look up table.
-		this->sprites.push_back(this->assets->MakePNGFromFile(file)); // make an openorbis PNG struct from the file struct.
+	DEBUGLOG << "init font!";
+	auto baked = this->assets->GetFileById(AssetIds::Files::FONT_WBF);
+	if (baked != nullptr) {
+		auto bakedFont = std::make_unique<BakedFont>();
+
+		const unsigned char* blob = this->assets->GetData(baked); // glyphs point into it, so it stays unpacked
+
+		if (blob != nullptr &&
+			bakedFont->Load(baked->rawSize, blob) &&
+			bakedFont->HasSize(FONT_MENU_SIZE) &&
+			bakedFont->HasSize(FONT_HELP_SIZE) &&
+			bakedFont->Covers(charset.c_str())) // a pack's strings may need more than was baked
+			this->font = std::move(bakedFont);
+		else
+			DEBUGLOG << "baked font unusable, falling back to freetype";
 	}
 
-	DEBUGLOG << "init audio!";
-	auto sound = this->assets->GetFileByName("audio.wav");
-	
-	this->AudioHandle = -1;
-	this->Playing = false;
-	this->SampleData = nullptr;
+	// only bring up freetype when there's no baked font to draw from.
+	if (this->font == nullptr) {
+		auto file = this->assets->GetFileById(AssetIds::Files::FONT_TTF);
+		std::unique_ptr<TTFont> ttFont(this->assets->MakeFontFromFile(file, this->scene));
 
-	int err = sceAudioOutInit();
-	if (err == 0 && sound != nullptr) {
-		DEBUGLOG << "sceAudio init ok";
+		if (ttFont != nullptr) {
+			ttFont->AddSize(FONT_MENU_SIZE);
+			ttFont->AddSize(FONT_HELP_SIZE);
+			this->font = std::move(ttFont);
+		}
+	}
 
-		this->AudioHandle = sceAudioOutOpen(ORBIS_USER_SERVICE_USER_ID_SYSTEM, ORBIS_AUDIO_OUT_PORT_TYPE_MAIN, 0, 256, 48000, PARAMS16);
+	this->loader.Start(LOADER_THREADS);
 
-		if (this->AudioHandle <= 0) {
-			DEBUGLOG << "sceAudioOut open fail";
-		}
-		else {
-			if (!drwav_init_memory(&this->DrWav, sound->data, sound->size, NULL)) {
-				DEBUGLOG << "drwav init fail :(";
-			}
-			else {
-				// Calculate the sample count and allocate a buffer for the sample data accordingly
-				size_t sampleCount = this->DrWav.totalPCMFrameCount * this->DrWav.channels;
-				this->SampleData = (drwav_int16 *)malloc(sampleCount * sizeof(drwav_int16));
+	// glyphs go first, they're all the menu needs.
+	this->GlyphsReady = this->loader.Submit<int>([this, charset]() {
+		uint64_t t = sceKernelGetProcessTime();
+		int prewarmed = 0;
+		if (this->font != nullptr)
+			prewarmed = this->font->Prewarm(charset.c_str(), FONT_PREWARM_THREADS);
 
-				// Decode the wav into pSampleData
-				drwav_read_pcm_frames_s16(&this->DrWav, this->DrWav.totalPCMFrameCount, this->SampleData);
+		DEBUGLOG << "prewarmed " << prewarmed << " glyphs for " << charset.size() << " chars in " << (sceKernelGetProcessTime() - t) << "us";
+		return prewarmed;
+	});
 
-				this->SampleCount = sampleCount;
+	DEBUGLOG << "init sprites!";
+	this->LoadSprites(spriteids);
 
-				DEBUGLOG << ".wav decoded and loaded!";
-			}
-		}
+	// a question needs a picture to pick and another one to go next.
+	if (this->sprites.GetCount() < 2) {
+		DEBUGLOG << "[GAME|ERROR]: only " << this->sprites.GetCount() << " sprites in the assets, need at least 2";
+		this->state = GameState::FAILED;
+		return;
 	}
-}
\ No newline at end of file
+
+	DEBUGLOG << "init audio!";
+	this->AudioReady = this->loader.Submit<bool>([this]() { return this->LoadAudio(); });
+
+	DEBUGLOG << "Load() queued " << this->loader.GetSubmitted() << " loads after " << (sceKernelGetProcessTime() - this->LoadStart) << "us";
+}
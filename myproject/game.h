@@ -6,11 +6,15 @@
 #include <vector>
 #include <thread>
 #include <mutex>
-#include "../../_common/graphics.h"
-#include "../../_common/png.h"
+#include "graphics.h"
+#include "png.h"
 
 #include "controller.h"
-#include "wgfs.h"
+#include "loader.h"
+#include "spritecache.h"
+#include "textrun.h"
+#include "vfs.h"
+#include "assetids.h"
 
 // Header library for decoding wav files
 #include "dr_wav.h"
@@ -24,29 +28,21 @@
 // Other defines
 #define CONTROLLER_ANY_USER -1
 
-// a simple enum cast macro.
-// Si - Silicon & "signed int"
-#define Si(x) (static_cast<signed int>(x))
-
-enum class GameStrings : int {
-	TITLE,
-	UNDER_TITLE,
-	START_TEXT,
-	QUESTION_FORMAT,
-	QUESTION_ALTVERB_FORMAT,
-	UNDER_PICTURE,
-	HUD_TEXT,
-	LOST_TEXT,
-	IDIOT_PNG_TEXT,
-	VERSION_TEXT
-};
-
 enum class GameState : int {
+	LOADING,
 	MENU,
 	LOST,
-	PLAY
+	PLAY,
+	FAILED // the assets can't make a game, nothing to do but say so
 };
 
+// A question ready to be shown: its picture and the text above it, already laid out.
+typedef struct _game_question {
+	int sprite;
+	bool answerIsYes;
+	TextRun text;
+} GameQuestion;
+
 enum class GameHAlign : int {
 	LEFT,
 	CENTER,
@@ -62,21 +58,42 @@ enum class GameVAlign : int {
 class Game {
 	Controller *con;
 	Scene2D *scene;
-	std::vector<PNG*> sprites;
+	SpriteCache sprites; // decoded when first needed, only a budget's worth stays around
 	std::vector<std::string> lookup;
-	std::unique_ptr<WGFS::Assets> assets;
+	std::unique_ptr<WGFS::VFS> assets;
 
-	std::vector<FT_Face*> fonts;
+	std::unique_ptr<Font> font; // baked glyphs when the archive has them, otherwise the TTF.
 
 	GameState state;
 
-	std::vector<std::string> strings;
-
-	std::string Question;
+	// views into the archive, NUL terminated and good for as long as the VFS is.
+	std::vector<std::string_view> strings;
+
+	// formats from the string table, parsed once.
+	TextFormat questionFormat;
+	TextFormat questionAltFormat;
+	TextFormat hudFormat;
+	TextFormat versionFormat;
+
+	// laid out once, only the question and the score ever change.
+	TextRun titleText;
+	TextRun underTitleText;
+	TextRun startText;
+	TextRun versionText;
+	TextRun underPictureText;
+	TextRun scoreText;
+	TextRun lostText;
+	TextRun idiotText;
 
 	int PLAYimageindex;
 	bool AnswerIsYes;
 
+	// the question on screen and the one after it, which is prepared in the background while
+	// the current one is up. answering just swaps the two.
+	GameQuestion questions[2];
+	int currentQuestion;
+	std::shared_future<bool> NextQuestionReady;
+
 	int Score;
 
 	unsigned long long Time;
@@ -93,17 +110,31 @@ class Game {
 	drwav DrWav;
 	drwav_int16 *SampleData;
 
+	uint64_t LoadStart;
+	std::shared_future<int> GlyphsReady; // the menu can't draw before this
+	std::shared_future<bool> AudioReady;
+
+	// last, so its workers are gone before anything they fill in.
+	AssetLoader loader;
+
+	void StateLoading();
 	void StateMenu();
 	void StatePlay();
 	void StateLost();
+	void StateFailed();
 	void SimpleAudioThread();
 	void HandleAudio();
 	void StopAudio();
 
-	void DrawTextAlign(GameHAlign ha, GameVAlign va, char* string, int fontIndex, int x, int y, Color col, TextDimm *out);
+	void InitText();
+	void LoadSprites(const std::vector<WGFS::AssetId>& ids);
+	bool LoadAudio();
+	// fxCol is the outline/shadow color of runs that have one, black keeps text readable on sprites.
+	void DrawTextAlign(GameHAlign ha, GameVAlign va, TextRun* run, int x, int y, Color col, TextDimm *out, Color fxCol = { 0, 0, 0 });
 	void DrawSpriteAlign(GameHAlign ha, GameVAlign va, int sprite, int x, int y, PNG_INFO* out);
 
 	void ChangeState(GameState s);
+	void PrepareNextQuestion();
 
 public:
 	void SetObjects(Controller* const& c, Scene2D* const& sc);
@@ -15,6 +15,10 @@ Scene2D::Scene2D(int w, int h, int pixelDepth)
 	this->depth = pixelDepth;
 	
 	this->frameBufferSize = this->width * this->height * this->depth;
+
+#ifdef GRAPHICS_USES_FONT
+	this->ftLoaded = false;
+#endif
 }
 
 Scene2D::~Scene2D()
@@ -27,8 +31,6 @@ Scene2D::~Scene2D()
 
 bool Scene2D::Init(size_t memSize, int numFrameBuffers)
 {
-	int rc;
-	
 	this->video = sceVideoOutOpen(ORBIS_VIDEO_USER_MAIN, ORBIS_VIDEO_OUT_BUS_MAIN, 0, 0);
 	this->videoMem = NULL;
 
@@ -38,26 +40,6 @@ bool Scene2D::Init(size_t memSize, int numFrameBuffers)
 		return false;
 	}
 	
-#ifdef GRAPHICS_USES_FONT
-	// Load freetype
-	rc = sceSysmoduleLoadModule(0x009A);
-
-	if (rc < 0)
-	{
-		DEBUGLOG << "Failed to load freetype: " << std::string(strerror(errno));
-		return false;
-	}
-
-	// Initialize freetype
-	rc = FT_Init_FreeType(&this->ftLib);
-
-	if (rc != 0)
-	{
-		DEBUGLOG << "Failed to initialize freetype: " << std::string(strerror(errno));
-		return false;
-	}
-#endif
-	
 	if(!initFlipQueue())
 	{
 		DEBUGLOG << "Failed to initialize flip queue: " << std::string(strerror(errno));
@@ -215,10 +197,44 @@ void Scene2D::FrameBufferClear()
 }
 
 #ifdef GRAPHICS_USES_FONT
+// FreeType is only loaded once someone actually asks for a TTF font,
+// games that draw with baked fonts never pay for the module.
+bool Scene2D::initFreeType()
+{
+	int rc;
+
+	if (this->ftLoaded)
+		return true;
+
+	// Load freetype
+	rc = sceSysmoduleLoadModule(0x009A);
+
+	if (rc < 0)
+	{
+		DEBUGLOG << "Failed to load freetype: " << std::string(strerror(errno));
+		return false;
+	}
+
+	// Initialize freetype
+	rc = FT_Init_FreeType(&this->ftLib);
+
+	if (rc != 0)
+	{
+		DEBUGLOG << "Failed to initialize freetype: " << std::string(strerror(errno));
+		return false;
+	}
+
+	this->ftLoaded = true;
+	return true;
+}
+
 bool Scene2D::InitFont(FT_Face *face, const char *fontPath, int fontSize)
 {
 	int rc;
 	
+	if (!initFreeType())
+		return false;
+
 	rc = FT_New_Face(this->ftLib, fontPath, 0, face);
 	
 	if(rc < 0)
@@ -236,6 +252,9 @@ bool Scene2D::InitMemFont(FT_Face *face, size_t bufSize, unsigned char* fontBuf,
 {
 	int rc;
 
+	if (!initFreeType())
+		return false;
+
 	rc = FT_New_Memory_Face(this->ftLib, fontBuf, bufSize, 0, face);
 
 	if (rc < 0)
@@ -248,6 +267,14 @@ bool Scene2D::InitMemFont(FT_Face *face, size_t bufSize, unsigned char* fontBuf,
 
 	return true;
 }
+
+bool Scene2D::InitMemFont(TTFont *font, size_t bufSize, const unsigned char* fontBuf)
+{
+	if (!initFreeType())
+		return false;
+
+	return font->Load(this->ftLib, bufSize, fontBuf);
+}
 #endif
 
 void Scene2D::FrameBufferFill(Color color)
@@ -281,6 +308,155 @@ void Scene2D::DrawRectangle(int x, int y, int w, int h, Color color)
 	}
 }
 
+void Scene2D::DrawImage(const uint32_t *pixels, int w, int h, int x, int y, int pitch)
+{
+	if (pitch == 0)
+		pitch = w;
+
+	// Clip once, then every visible row is a straight copy
+	int xStart = x < 0 ? -x : 0;
+	int yStart = y < 0 ? -y : 0;
+	int xEnd = (x + w > this->width) ? this->width - x : w;
+	int yEnd = (y + h > this->height) ? this->height - y : h;
+
+	if (xStart >= xEnd)
+		return;
+
+	uint32_t *fb = (uint32_t *)this->frameBuffers[this->activeFrameBufferIdx];
+
+	for (int yPos = yStart; yPos < yEnd; yPos++)
+	{
+		memcpy(fb + ((y + yPos) * this->width) + x + xStart, pixels + (yPos * pitch) + xStart, (xEnd - xStart) * sizeof(uint32_t));
+	}
+}
+
+void Scene2D::DrawGlyph(const Glyph *glyph, int x, int y, Color fgColor, Color fxColor)
+{
+	// Clip the glyph rectangle against the frame buffer once instead of per pixel
+	int x0 = x + glyph->left;
+	int y0 = y - glyph->top;
+
+	int xStart = x0 < 0 ? -x0 : 0;
+	int yStart = y0 < 0 ? -y0 : 0;
+	int xEnd = (x0 + glyph->w > this->width) ? this->width - x0 : glyph->w;
+	int yEnd = (y0 + glyph->h > this->height) ? this->height - y0 : glyph->h;
+
+	uint32_t *fb = (uint32_t *)this->frameBuffers[this->activeFrameBufferIdx];
+
+	if (glyph->effect == nullptr)
+	{
+		for (int yPos = yStart; yPos < yEnd; yPos++)
+		{
+			const uint8_t *src = glyph->bitmap + (yPos * glyph->pitch);
+			uint32_t *dst = fb + ((y0 + yPos) * this->width) + x0;
+
+			for (int xPos = xStart; xPos < xEnd; xPos++)
+			{
+				uint8_t pixel = src[xPos];
+
+				// Blank pixels keep whatever is already in the frame buffer
+				if (pixel == 0)
+					continue;
+
+				// Linearly interpolate between black and the foreground, same as the FreeType path
+				uint8_t r = (pixel * fgColor.r) / 255;
+				uint8_t g = (pixel * fgColor.g) / 255;
+				uint8_t b = (pixel * fgColor.b) / 255;
+
+				dst[xPos] = 0x80000000 + (r << 16) + (g << 8) + b;
+			}
+		}
+
+		return;
+	}
+
+	// Outline/shadow glyphs: the fill goes on top of the effect, both in a single pass.
+	// Effects sit on top of sprites, so their soft edges blend into what's already there
+	for (int yPos = yStart; yPos < yEnd; yPos++)
+	{
+		const uint8_t *src = glyph->bitmap + (yPos * glyph->pitch);
+		const uint8_t *fx = glyph->effect + (yPos * glyph->pitch);
+		uint32_t *dst = fb + ((y0 + yPos) * this->width) + x0;
+
+		for (int xPos = xStart; xPos < xEnd; xPos++)
+		{
+			int fill = src[xPos];
+			int edge = fx[xPos];
+
+			if (fill == 0 && edge == 0)
+				continue;
+
+			// Whatever the fill doesn't cover is left to the effect, and what neither covers to the background
+			int rest = ((255 - fill) * edge) / 255;
+			int back = 255 - fill - rest;
+
+			uint32_t under = dst[xPos];
+			int ur = (under >> 16) & 0xFF;
+			int ug = (under >> 8) & 0xFF;
+			int ub = under & 0xFF;
+
+			uint8_t r = ((fill * fgColor.r) + (rest * fxColor.r) + (back * ur)) / 255;
+			uint8_t g = ((fill * fgColor.g) + (rest * fxColor.g) + (back * ug)) / 255;
+			uint8_t b = ((fill * fgColor.b) + (rest * fxColor.b) + (back * ub)) / 255;
+
+			dst[xPos] = 0x80000000 + (r << 16) + (g << 8) + b;
+		}
+	}
+}
+
+void Scene2D::DrawText(const char *txt, Font *font, int pixelSize, int startX, int startY, Color fgColor, TextEffect effect, Color fxColor)
+{
+	int xOffset = 0;
+	int yOffset = 0;
+	int lineHeight = font->GetLineHeight(pixelSize);
+
+	for (const char *c = txt; *c != '\0'; c++)
+	{
+		if (*c == '\n')
+		{
+			xOffset = 0;
+			yOffset += lineHeight;
+			continue;
+		}
+
+		const Glyph *glyph = font->GetGlyph(pixelSize, (unsigned char)*c, effect);
+		if (glyph == nullptr)
+			continue;
+
+		this->DrawGlyph(glyph, startX + xOffset, startY + yOffset, fgColor, fxColor);
+		xOffset += glyph->advance;
+	}
+}
+
+void Scene2D::CalcTextDimm(const char *txt, Font *font, int pixelSize, TextDimm *textDimm)
+{
+	int xOffset = 0;
+	int lineHeight = font->GetLineHeight(pixelSize);
+
+	textDimm->w = 0;
+	textDimm->h = lineHeight;
+
+	for (const char *c = txt; *c != '\0'; c++)
+	{
+		if (*c == '\n')
+		{
+			xOffset = 0;
+			textDimm->h += lineHeight;
+			continue;
+		}
+
+		const Glyph *glyph = font->GetGlyph(pixelSize, (unsigned char)*c, TextEffect::NONE);
+		if (glyph == nullptr)
+			continue;
+
+		xOffset += glyph->advance;
+
+		// The widest line wins
+		if (textDimm->w < xOffset)
+			textDimm->w = xOffset;
+	}
+}
+
 #ifdef GRAPHICS_USES_FONT
 void Scene2D::DrawTextContainer(char *txt, FT_Face face, int startX, int startY, int maxW, int maxH, Color bgColor, Color fgColor)
 {
@@ -6,6 +6,8 @@
 #ifndef GRAPHICS_H
 #define GRAPHICS_H
 
+#include "font.h"
+
 #define GRAPHICS_USES_FONT
 
 #ifdef GRAPHICS_USES_FONT
@@ -29,6 +31,7 @@ class Scene2D
 {
 #ifdef GRAPHICS_USES_FONT
 	FT_Library ftLib;
+	bool ftLoaded;
 #endif
 	
 	int width;
@@ -57,6 +60,10 @@ class Scene2D
 	bool allocateVideoMem(size_t size, int alignment);
 	void deallocateVideoMem();
 
+#ifdef GRAPHICS_USES_FONT
+	bool initFreeType();
+#endif
+
 public:
 	Scene2D(int w, int h, int pixelDepth);
 	~Scene2D();
@@ -73,10 +80,19 @@ public:
 	
 	void DrawPixel(int x, int y, Color color);
 	void DrawRectangle(int x, int y, int w, int h, Color color);
+	// pixels already in frame buffer format (0x80RRGGBB), copied a row at a time. rows are pitch
+	// pixels apart (w when it's 0), so a rect out of a bigger image can be drawn in place.
+	void DrawImage(const uint32_t *pixels, int w, int h, int x, int y, int pitch = 0);
+
+	// Text from pre-rasterised glyphs, no FreeType involved.
+	void DrawGlyph(const Glyph *glyph, int x, int y, Color fgColor, Color fxColor);
+	void DrawText(const char *txt, Font *font, int pixelSize, int startX, int startY, Color fgColor, TextEffect effect = TextEffect::NONE, Color fxColor = { 0, 0, 0 });
+	void CalcTextDimm(const char *txt, Font *font, int pixelSize, TextDimm *textDimm);
 	
 #ifdef GRAPHICS_USES_FONT
 	bool InitFont(FT_Face *face, const char *fontPath, int fontSize);
 	bool InitMemFont(FT_Face *face, size_t bufSize, unsigned char* fontBuf, int fontSize);
+	bool InitMemFont(TTFont *font, size_t bufSize, const unsigned char* fontBuf);
 	void DrawText(char *txt, FT_Face face, int startX, int startY, Color bgColor, Color fgColor);
 	void CalcTextDimm(char *txt, FT_Face face, TextDimm *textDimm);
 	void DrawTextContainer(char *txt, FT_Face face, int startX, int startY, int maxW, int maxH, Color bgColor, Color fgColor);
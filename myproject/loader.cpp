@@ -0,0 +1,68 @@
+#include "loader.h"
+
+AssetLoader::AssetLoader()
+{
+	this->stopping = false;
+	this->submitted = 0;
+	this->finished = 0;
+}
+
+AssetLoader::~AssetLoader()
+{
+	{
+		std::lock_guard<std::mutex> guard(this->lock);
+		this->stopping = true;
+	}
+
+	this->wake.notify_all();
+	for (auto& w : this->workers) w.join();
+}
+
+void AssetLoader::Start(int threads)
+{
+	for (int i = 0; i < threads; i++)
+		this->workers.emplace_back(&AssetLoader::Worker, this);
+}
+
+void AssetLoader::Push(std::function<void()> job)
+{
+	this->submitted++;
+
+	{
+		std::lock_guard<std::mutex> guard(this->lock);
+		this->jobs.push_back(std::move(job));
+	}
+
+	this->wake.notify_one();
+}
+
+void AssetLoader::Worker()
+{
+	for (;;) {
+		std::function<void()> job;
+
+		{
+			std::unique_lock<std::mutex> guard(this->lock);
+			this->wake.wait(guard, [this]() { return this->stopping || !this->jobs.empty(); });
+
+			// stopping only ends the worker once the queue is drained.
+			if (this->jobs.empty()) return;
+
+			job = std::move(this->jobs.front());
+			this->jobs.pop_front();
+		}
+
+		job();
+		this->finished++;
+	}
+}
+
+int AssetLoader::GetSubmitted()
+{
+	return this->submitted;
+}
+
+int AssetLoader::GetFinished()
+{
+	return this->finished;
+}
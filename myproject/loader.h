@@ -0,0 +1,56 @@
+#ifndef _LOADER_H_
+#define _LOADER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A few worker threads that load assets in the background. Submit hands back a future for the
+// result, so the game can keep drawing frames and only wait for the one thing it needs right now.
+class AssetLoader {
+	std::vector<std::thread> workers;
+	std::deque<std::function<void()>> jobs;
+	std::mutex lock;
+	std::condition_variable wake;
+	bool stopping;
+	std::atomic<int> submitted;
+	std::atomic<int> finished;
+
+	void Worker();
+	void Push(std::function<void()> job);
+
+public:
+	AssetLoader();
+	~AssetLoader(); // runs whatever is still queued, then joins the workers.
+
+	void Start(int threads);
+
+	template <class T>
+	std::shared_future<T> Submit(std::function<T()> job)
+	{
+		auto task = std::make_shared<std::packaged_task<T()>>(std::move(job));
+		std::shared_future<T> ret = task->get_future().share();
+
+		this->Push([task]() { (*task)(); });
+		return ret;
+	}
+
+	// for progress bars, finished never passes submitted.
+	int GetSubmitted();
+	int GetFinished();
+};
+
+// true once the future has its value, never blocks.
+template <class T>
+bool IsReady(const std::shared_future<T>& f)
+{
+	return f.valid() && f.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+#endif // _LOADER_H_
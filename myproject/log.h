@@ -1,34 +1,38 @@
 #include <sstream>
 #include <iostream>
+#include <mutex>
 
 #ifndef LOG_H
 #define LOG_H
 
 // Logging stuff
-extern std::stringstream debugLogStream;
+// Loading runs on worker threads too, so every line is built on its own and this is only held
+// while it's printed. Nothing that's logged runs under it, whatever locks that takes.
+inline std::mutex debugLogLock;
 
 class Log
 {
+	std::ostringstream line;
+
 public:
 	Log(const std::string &funcName)
 	{
-		debugLogStream << funcName << ": ";
+		this->line << funcName << ": ";
 	}
 	
 	template <class T>
 	Log &operator<<(const T &v)
 	{
-		debugLogStream << v;
+		this->line << v;
 		return *this;
 	}
 	
 	~Log()
 	{
-		debugLogStream << std::endl;
-		printf("%s", debugLogStream.str().c_str());
-		
-		// Clear the stream
-		debugLogStream.str("");
+		this->line << std::endl;
+
+		std::lock_guard<std::mutex> lock(debugLogLock);
+		printf("%s", this->line.str().c_str());
 	}
 };
 
@@ -0,0 +1,64 @@
+#include <string.h>
+
+#include "lz4.h"
+
+namespace LZ4
+{
+	// lengths of 15 go on in extra bytes, each 255 means another one follows.
+	static bool ReadLength(const uint8_t** ip, const uint8_t* end, size_t* len)
+	{
+		uint8_t b;
+		do {
+			if (*ip >= end) return false;
+			b = *(*ip)++;
+			*len += b;
+		} while (b == 255);
+
+		return true;
+	}
+
+	int DecompressBlock(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize)
+	{
+		const uint8_t* ip = src;
+		const uint8_t* const iend = src + srcSize;
+		uint8_t* op = dst;
+		uint8_t* const oend = dst + dstSize;
+
+		while (ip < iend) {
+			uint8_t token = *ip++;
+
+			size_t lit = token >> 4;
+			if (lit == 15 && !ReadLength(&ip, iend, &lit)) return -1;
+			if ((size_t)(iend - ip) < lit || (size_t)(oend - op) < lit) return -1;
+
+			memcpy(op, ip, lit);
+			ip += lit;
+			op += lit;
+
+			// the last sequence is literals only.
+			if (ip == iend) break;
+
+			if (iend - ip < 2) return -1;
+			size_t offset = ip[0] | (ip[1] << 8);
+			ip += 2;
+			if (offset == 0 || offset > (size_t)(op - dst)) return -1;
+
+			size_t len = token & 15;
+			if (len == 15 && !ReadLength(&ip, iend, &len)) return -1;
+			len += 4;
+			if ((size_t)(oend - op) < len) return -1;
+
+			const uint8_t* match = op - offset;
+			if (offset >= len) {
+				memcpy(op, match, len);
+				op += len;
+			}
+			else {
+				// overlapping, the match repeats what it just wrote.
+				for (size_t i = 0; i < len; i++) *op++ = *match++;
+			}
+		}
+
+		return (int)(op - dst);
+	}
+}
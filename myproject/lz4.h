@@ -0,0 +1,17 @@
+#ifndef _LZ4_H_
+#define _LZ4_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+// A small LZ4 block decoder, compatible with the reference format
+// (https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md).
+// Only single blocks, frames and dictionaries aren't supported.
+namespace LZ4
+{
+	// Unpacks one block into dst, returns the unpacked size or -1 when the block is malformed
+	// or wouldn't fit. Never reads or writes outside the given buffers.
+	int DecompressBlock(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize);
+}
+
+#endif // _LZ4_H_
@@ -1,15 +1,12 @@
 #include <sstream>
 #include <orbis/SystemService.h>
 
-#include "../../_common/png.h"
-#include "../../_common/log.h"
-#include "../../_common/graphics.h"
+#include "png.h"
+#include "log.h"
+#include "graphics.h"
 #include "controller.h"
 #include "game.h"
 
-// Logging
-std::stringstream debugLogStream;
-
 int main(void) {
 
     // No buffering
@@ -49,7 +46,7 @@ int main(void) {
     
     // Main loop
 	DEBUGLOG << "--> Entering main loop...";
-	sceSystemServiceHideSplashScreen(); // we've loaded everything, can hide the splash.
+	sceSystemServiceHideSplashScreen(); // the rest loads behind the LOADING state, can hide the splash.
 	
     for (;;)
     {
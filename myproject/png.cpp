@@ -1,31 +1,68 @@
 #define STBI_ASSERT(x)
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb/stb_image.h>
+#include <stdlib.h>
 
 #include "graphics.h"
 #include "png.h"
 #include "log.h"
+#include "wgfsformat.h"
 
-PNG::PNG(size_t bufsize, unsigned char* bufpng)
+PNG::PNG(size_t bufsize, const unsigned char* bufpng)
 {
+	this->pixels = NULL;
+	this->pitch = 0;
 	this->img = (uint32_t*)stbi_load_from_memory((stbi_uc*)bufpng, bufsize, &this->width, &this->height, &this->channels, STBI_rgb_alpha);
 
 	if (this->img == NULL)
 	{
 		DEBUGLOG << "Failed to load image from memory: " << stbi_failure_reason();
+		this->width = this->height = this->channels = 0;
 		return;
 	}
+
+	this->MakeNative();
+}
+
+PNG::PNG(int w, int h, const uint32_t* nativePixels, int pitch)
+{
+	// nothing to decode, the packer already did
+	this->width = w;
+	this->height = h;
+	this->pitch = pitch != 0 ? pitch : w;
+	this->channels = 4;
+	this->img = NULL;
+	this->pixels = nativePixels;
 }
 
 PNG::PNG(const char *imagePath)
 {
+	this->pixels = NULL;
+	this->pitch = 0;
 	this->img = (uint32_t *)stbi_load(imagePath, &this->width, &this->height, &this->channels, STBI_rgb_alpha);
 
  	if (this->img == NULL)
 	{
 		DEBUGLOG << "Failed to load image '" << imagePath << "': " << stbi_failure_reason();
+		this->width = this->height = this->channels = 0;
 		return;
 	}
+
+	this->MakeNative();
+}
+
+void PNG::MakeNative()
+{
+	// Re-encode every pixel once here instead of on every draw
+	int count = this->width * this->height;
+	for (int i = 0; i < count; i++)
+	{
+		uint32_t c = this->img[i];
+		this->img[i] = WGFS::NativePixel((uint8_t)(c >> 0), (uint8_t)(c >> 8), (uint8_t)(c >> 16));
+	}
+
+	this->pixels = this->img;
+	this->pitch = this->width;
 }
 
 PNG::~PNG()
@@ -41,37 +78,28 @@ void PNG::GetInfo(PNG_INFO* ptr)
 	ptr->channels = this->channels;
 }
 
-void PNG::Draw(Scene2D *scene, int startX, int startY)
+PNG *PNG::Resized(int w, int h, Resample::Filter filter)
 {
-	// Don't draw non-existant images
-	if(this->img == NULL)
-		return;
-		
-	// Iterate the bitmap and draw the pixels
-	for (int yPos = 0; yPos < this->height; yPos++)
-	{
-		for (int xPos = 0; xPos < this->width; xPos++)
-		{
-			// Decode the 32-bit color
-			uint32_t encodedColor = this->img[(yPos * this->width) + xPos];
+	if (this->pixels == NULL || w <= 0 || h <= 0)
+		return NULL;
 
-			// Get new pixel coordinates to account for start coordinates
-			int x = startX + xPos;
- 			int y = startY + yPos;
+	// malloc'd like stb's own, so the destructor frees it the same way
+	uint32_t *scaled = (uint32_t *)malloc((size_t)w * h * sizeof(uint32_t));
+	if (scaled == NULL)
+		return NULL;
 
-			// Re-encode the color
-			uint8_t r = (uint8_t)(encodedColor >> 0);
-			uint8_t g = (uint8_t)(encodedColor >> 8);
-			uint8_t b = (uint8_t)(encodedColor >> 16);
+	Resample::Pixels(this->pixels, this->width, this->height, this->pitch, scaled, w, h, filter);
 
-			Color color = { r, g, b };
+	PNG *ret = new PNG(w, h, scaled);
+	ret->img = scaled;
+	return ret;
+}
 
-			// Do some bounds checking to make sure the pixel is actually inside the frame buffer
-			if (xPos < 0 || yPos < 0 || xPos >= this->width || yPos >= this->height)
-				continue;
+void PNG::Draw(Scene2D *scene, int startX, int startY)
+{
+	// Don't draw non-existant images
+	if(this->pixels == NULL)
+		return;
 
-			scene->DrawPixel(x, y, color);
-		}
-	}
+	scene->DrawImage(this->pixels, this->width, this->height, startX, startY, this->pitch);
 }
-
@@ -1,4 +1,5 @@
 #include "graphics.h"
+#include "resample.h"
 
 #ifndef PNG_H
 #define PNG_H
@@ -13,14 +14,25 @@ class PNG {
 	int width;
 	int height;
 	int channels;
-	uint32_t *img;
+	int pitch;              // pixels from one row to the next
+	uint32_t *img;          // what stb decoded, NULL for adopted pixels
+	const uint32_t *pixels; // frame buffer format, img or someone else's memory
+
+	void MakeNative();
 
 public:
 	PNG(const char *imagePath);
-	PNG(size_t bufsize, unsigned char* bufpng);
+	PNG(size_t bufsize, const unsigned char* bufpng);
+	// adopts pixels that are already in frame buffer format, they have to outlive the PNG.
+	// pitch is for a rect out of a bigger image (an atlas page), 0 when the rows are w apart.
+	PNG(int w, int h, const uint32_t* nativePixels, int pitch = 0);
 	~PNG();
 
+	// a copy scaled to w x h, nullptr when there's nothing to scale.
+	PNG *Resized(int w, int h, Resample::Filter filter);
+
 	void Draw(Scene2D *scene, int startX, int startY);
+	// 0 x 0 when the image didn't decode.
 	void GetInfo(PNG_INFO* out);
 };
 
@@ -0,0 +1,223 @@
+#include <math.h>
+#include <string.h>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "resample.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace Resample
+{
+	// taps for one output pixel along one axis: the first source index and count weights for the
+	// source pixels from there on, all inside the source and summing to 1.
+	typedef struct _resample_axis {
+		int taps; // the most any output pixel has, weights are laid out this far apart
+		std::vector<int> first;
+		std::vector<int> count;
+		std::vector<float> weights; // taps per output pixel, count of them used
+	} Axis;
+
+	static float Kernel(Filter filter, float x)
+	{
+		x = fabsf(x);
+		if (filter == Filter::BILINEAR) return x < 1.0f ? 1.0f - x : 0.0f;
+
+		if (x < 1e-6f) return 1.0f;
+		if (x >= 3.0f) return 0.0f;
+
+		const float pi = 3.14159265358979f;
+		float px = pi * x;
+		return 3.0f * sinf(px) * sinf(px / 3.0f) / (px * px);
+	}
+
+	static void MakeAxis(int srcN, int dstN, Filter filter, Axis* axis)
+	{
+		float scale = (float)srcN / dstN;
+		float stretch = scale > 1.0f ? scale : 1.0f; // shrinking: the kernel covers scale pixels
+		float support = (filter == Filter::BILINEAR ? 1.0f : 3.0f) * stretch;
+
+		axis->taps = (int)ceilf(support) * 2 + 1;
+		axis->first.resize(dstN);
+		axis->count.resize(dstN);
+		axis->weights.assign((size_t)dstN * axis->taps, 0.0f);
+
+		for (int i = 0; i < dstN; i++) {
+			float center = (i + 0.5f) * scale - 0.5f;
+			int first = (int)floorf(center - support) + 1;
+			float* w = &axis->weights[(size_t)i * axis->taps];
+
+			float sum = 0.0f;
+			for (int t = 0; t < axis->taps; t++) {
+				w[t] = Kernel(filter, (first + t - center) / stretch);
+				sum += w[t];
+			}
+
+			// the taps past an edge become the edge pixel, so move their weight onto it.
+			int lo = first < 0 ? -first : 0;
+			int hi = first + axis->taps > srcN ? srcN - first : axis->taps;
+			for (int t = 0; t < lo && lo < axis->taps; t++) {
+				w[lo] += w[t];
+				w[t] = 0.0f;
+			}
+			for (int t = hi; t < axis->taps && hi > 0; t++) {
+				w[hi - 1] += w[t];
+				w[t] = 0.0f;
+			}
+
+			for (int t = 0; t < axis->taps; t++) w[t] /= sum;
+
+			// only the run between the first and last weight that counts is kept, moved to the
+			// front. that's always inside the source, so filtering needs no clamping or skipping.
+			int used = 0;
+			while (used < axis->taps - 1 && w[used] == 0.0f) used++;
+			int last = axis->taps - 1;
+			while (last > used && w[last] == 0.0f) last--;
+
+			memmove(w, w + used, (last - used + 1) * sizeof(float));
+			std::fill(w + (last - used + 1), w + axis->taps, 0.0f);
+			axis->first[i] = first + used;
+			axis->count[i] = last - used + 1;
+		}
+	}
+
+	static inline int Clamp(int v, int lo, int hi)
+	{
+		return v < lo ? lo : (v > hi ? hi : v);
+	}
+
+	// one source row widened to a float per byte, 4 pixels (16 bytes) a step.
+	static void WidenRow(const uint32_t* src, int srcW, float* out)
+	{
+		int i = 0;
+#ifdef __SSE2__
+		const __m128i zero = _mm_setzero_si128();
+		for (; i + 4 <= srcW; i += 4) {
+			__m128i px = _mm_loadu_si128((const __m128i*)(src + i));
+			__m128i lo = _mm_unpacklo_epi8(px, zero);
+			__m128i hi = _mm_unpackhi_epi8(px, zero);
+
+			_mm_storeu_ps(out + (size_t)i * 4, _mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)));
+			_mm_storeu_ps(out + (size_t)i * 4 + 4, _mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)));
+			_mm_storeu_ps(out + (size_t)i * 4 + 8, _mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)));
+			_mm_storeu_ps(out + (size_t)i * 4 + 12, _mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)));
+		}
+#endif
+		for (; i < srcW; i++) {
+			for (int c = 0; c < 4; c++) out[(size_t)i * 4 + c] = (float)((src[i] >> (c * 8)) & 0xFF);
+		}
+	}
+
+	// a widened row filtered across into dstW float4 pixels. the 4 bytes of a pixel share a
+	// register and a pixel's taps are next to each other, so every tap is one load and one
+	// multiply-add straight down the line.
+	static void FilterRow(const float* line, const Axis& x, float* out)
+	{
+		int dstW = (int)x.first.size();
+		for (int i = 0; i < dstW; i++) {
+			const float* w = &x.weights[(size_t)i * x.taps];
+			const float* px = line + (size_t)x.first[i] * 4;
+			int count = x.count[i];
+
+#ifdef __SSE2__
+			// two sums, so one multiply-add doesn't wait on the last.
+			__m128 even = _mm_setzero_ps();
+			__m128 odd = _mm_setzero_ps();
+			int t = 0;
+			for (; t + 2 <= count; t += 2) {
+				even = _mm_add_ps(even, _mm_mul_ps(_mm_loadu_ps(px + t * 4), _mm_set1_ps(w[t])));
+				odd = _mm_add_ps(odd, _mm_mul_ps(_mm_loadu_ps(px + t * 4 + 4), _mm_set1_ps(w[t + 1])));
+			}
+			if (t < count) even = _mm_add_ps(even, _mm_mul_ps(_mm_loadu_ps(px + t * 4), _mm_set1_ps(w[t])));
+
+			_mm_storeu_ps(out + (size_t)i * 4, _mm_add_ps(even, odd));
+#else
+			float acc[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			for (int t = 0; t < count; t++) {
+				for (int c = 0; c < 4; c++) acc[c] += px[t * 4 + c] * w[t];
+			}
+			memcpy(out + (size_t)i * 4, acc, sizeof(acc));
+#endif
+		}
+	}
+
+	static void StoreRow(const float* acc, int dstW, uint32_t* dst)
+	{
+#ifdef __SSE2__
+		for (int i = 0; i < dstW; i++) {
+			// rounds to nearest, the packs saturate whatever Lanczos overshot.
+			__m128i v = _mm_cvtps_epi32(_mm_loadu_ps(acc + (size_t)i * 4));
+			v = _mm_packs_epi32(v, v);
+			dst[i] = (uint32_t)_mm_cvtsi128_si32(_mm_packus_epi16(v, v));
+		}
+#else
+		for (int i = 0; i < dstW; i++) {
+			uint32_t px = 0;
+			for (int c = 0; c < 4; c++) px |= (uint32_t)Clamp((int)lrintf(acc[(size_t)i * 4 + c]), 0, 255) << (c * 8);
+			dst[i] = px;
+		}
+#endif
+	}
+
+	void FitSize(int w, int h, int boxW, int boxH, int* fitW, int* fitH)
+	{
+		if ((long long)w * boxH > (long long)h * boxW) {
+			*fitW = boxW;
+			*fitH = (int)(((long long)h * boxW + w / 2) / w);
+		}
+		else {
+			*fitH = boxH;
+			*fitW = (int)(((long long)w * boxH + h / 2) / h);
+		}
+
+		if (*fitW < 1) *fitW = 1;
+		if (*fitH < 1) *fitH = 1;
+	}
+
+	void Pixels(const uint32_t* src, int srcW, int srcH, int srcPitch, uint32_t* dst, int dstW, int dstH, Filter filter)
+	{
+		Axis x, y;
+		MakeAxis(srcW, dstW, filter, &x);
+		MakeAxis(srcH, dstH, filter, &y);
+
+		// filtered rows are kept in a ring as big as one output row's taps. an output row only needs
+		// a run of neighbouring source rows and the runs move down, so the ones it needs never
+		// share a slot and every source row is filtered once.
+		int ring = y.taps;
+		size_t rowFloats = (size_t)dstW * 4;
+		std::unique_ptr<float[]> rows(new float[rowFloats * ring]);
+		std::vector<int> slotRow(ring, -1);
+		std::unique_ptr<float[]> acc(new float[rowFloats]);
+		std::unique_ptr<float[]> line(new float[(size_t)srcW * 4]);
+
+		for (int j = 0; j < dstH; j++) {
+			const float* w = &y.weights[(size_t)j * y.taps];
+			std::fill(acc.get(), acc.get() + rowFloats, 0.0f);
+
+			for (int t = 0; t < y.count[j]; t++) {
+				int row = y.first[j] + t;
+				int slot = row % ring;
+				float* filtered = rows.get() + rowFloats * slot;
+				if (slotRow[slot] != row) {
+					WidenRow(src + (size_t)row * srcPitch, srcW, line.get());
+					FilterRow(line.get(), x, filtered);
+					slotRow[slot] = row;
+				}
+
+#ifdef __SSE2__
+				__m128 wt = _mm_set1_ps(w[t]);
+				for (size_t i = 0; i < rowFloats; i += 4)
+					_mm_storeu_ps(acc.get() + i, _mm_add_ps(_mm_loadu_ps(acc.get() + i), _mm_mul_ps(_mm_loadu_ps(filtered + i), wt)));
+#else
+				for (size_t i = 0; i < rowFloats; i++) acc[i] += filtered[i] * w[t];
+#endif
+			}
+
+			StoreRow(acc.get(), dstW, dst + (size_t)j * dstW);
+		}
+	}
+}
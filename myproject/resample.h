@@ -0,0 +1,27 @@
+#ifndef _RESAMPLE_H_
+#define _RESAMPLE_H_
+
+#include <stdint.h>
+
+// Sprite scaling, done once when a sprite is packed (or loaded, for what wasn't) so drawing stays a
+// row copy. Separable: every row is filtered across, then the rows are filtered down. Each byte of
+// a pixel is filtered on its own, so it works for RGBA as well as frame buffer pixels.
+// With SSE2 (always there on x86-64) rows are widened to floats 4 pixels a step and the pass down
+// runs over whole rows 4 floats a step. Across a row the 4 bytes of a pixel share a register, one
+// multiply-add per tap. Plain floats without it.
+namespace Resample
+{
+	enum class Filter : int {
+		BILINEAR, // soft, cheapest
+		LANCZOS3  // sharper, a bit of ringing on hard edges
+	};
+
+	// the biggest size with w:h's aspect ratio that fits boxW x boxH, at least 1x1.
+	void FitSize(int w, int h, int boxW, int boxH, int* fitW, int* fitH);
+
+	// src is srcW x srcH pixels with rows srcPitch pixels apart, dst gets dstW x dstH packed rows.
+	// shrinking widens the filter, so every source pixel counts.
+	void Pixels(const uint32_t* src, int srcW, int srcH, int srcPitch, uint32_t* dst, int dstW, int dstH, Filter filter);
+}
+
+#endif // _RESAMPLE_H_
@@ -0,0 +1,191 @@
+#include "spritecache.h"
+#include "log.h"
+
+SpriteCache::SpriteCache()
+{
+	this->assets = nullptr;
+	this->loader = nullptr;
+	this->budget = 0;
+	this->used = 0;
+	this->broken = 0;
+	this->fitW = 0;
+	this->fitH = 0;
+}
+
+SpriteCache::~SpriteCache()
+{
+	for (int i : this->lru) {
+		PNG* png = this->entries[i].png.get();
+		if (png != nullptr) delete png;
+	}
+}
+
+void SpriteCache::Init(WGFS::VFS* assets, AssetLoader* loader, size_t budget, int fitW, int fitH)
+{
+	this->assets = assets;
+	this->loader = loader;
+	this->budget = budget;
+	this->fitW = fitW;
+	this->fitH = fitH;
+}
+
+int SpriteCache::Add(WGFS::File* file)
+{
+	SpriteEntry e;
+	e.file = file;
+	e.bytes = 0;
+	e.broken = false;
+	e.lru = this->lru.end();
+
+	this->entries.push_back(e);
+	return (int)this->entries.size() - 1;
+}
+
+size_t SpriteCache::GetCount()
+{
+	return this->entries.size();
+}
+
+bool SpriteCache::IsBroken(int index)
+{
+	return this->entries[index].broken;
+}
+
+size_t SpriteCache::GetBrokenCount()
+{
+	return this->broken;
+}
+
+size_t SpriteCache::GetUsedBytes()
+{
+	return this->used;
+}
+
+void SpriteCache::Touch(int index)
+{
+	SpriteEntry& e = this->entries[index];
+	if (e.lru == this->lru.end()) {
+		this->lru.push_front(index);
+		e.lru = this->lru.begin();
+	}
+	else {
+		this->lru.splice(this->lru.begin(), this->lru, e.lru);
+	}
+}
+
+void SpriteCache::Request(int index)
+{
+	SpriteEntry& e = this->entries[index];
+	if (e.broken) return;
+
+	if (!e.png.valid()) {
+		WGFS::File* file = e.file;
+		WGFS::VFS* assets = this->assets;
+		int fitW = this->fitW;
+		int fitH = this->fitH;
+
+		e.png = this->loader->Submit<PNG*>([file, assets, fitW, fitH]() {
+			uint64_t t = sceKernelGetProcessTime();
+			PNG* png = assets->MakePNGFromFile(file); // make an openorbis PNG struct from the file struct.
+
+			PNG_INFO info = { 0, 0, 0 };
+			if (png != nullptr) png->GetInfo(&info);
+
+			int w, h;
+			if (fitW > 0 && fitH > 0 && info.w > 0 && info.h > 0) {
+				Resample::FitSize(info.w, info.h, fitW, fitH, &w, &h);
+
+				PNG* scaled = (w != info.w || h != info.h) ? png->Resized(w, h, Resample::Filter::LANCZOS3) : nullptr;
+				if (scaled != nullptr) {
+					// the scaled copy has its own pixels, the archive's (or the page's) can go.
+					delete png;
+					assets->ReleaseData(file);
+					png = scaled;
+				}
+			}
+
+			DEBUGLOG << "sprite " << file->name << " took " << (sceKernelGetProcessTime() - t) << "us";
+			return png;
+		});
+	}
+
+	this->Touch(index);
+	this->Trim();
+}
+
+PNG* SpriteCache::Get(int index)
+{
+	this->Request(index);
+
+	SpriteEntry& e = this->entries[index];
+	if (e.broken) return nullptr;
+
+	// only waits when this very sprite is still decoding.
+	this->Settle(e);
+	return e.png.get();
+}
+
+void SpriteCache::Settle(SpriteEntry& e)
+{
+	if (e.broken || e.png.get() != nullptr) return;
+
+	DEBUGLOG << "[SPRITES|ERROR]: " << e.file->name << " didn't decode, leaving it out";
+	e.broken = true;
+	this->broken++;
+}
+
+void SpriteCache::Account()
+{
+	// sizes show up as decodes finish.
+	for (int i : this->lru) {
+		SpriteEntry& e = this->entries[i];
+		if (e.bytes != 0 || !IsReady(e.png)) continue;
+
+		PNG_INFO info = { 0, 0, 0 };
+		PNG* png = e.png.get();
+		if (png != nullptr) png->GetInfo(&info);
+		this->Settle(e);
+
+		// a failed decode still takes a slot so it isn't retried every frame.
+		e.bytes = (size_t)info.w * info.h * 4;
+		if (e.bytes == 0) e.bytes = 1;
+		this->used += e.bytes;
+	}
+}
+
+void SpriteCache::Trim()
+{
+	this->Account();
+
+	// walk from the oldest, skipping whatever is still decoding. pos is where it sits in the list.
+	auto it = this->lru.end();
+	size_t pos = this->lru.size();
+	while (this->used > this->budget && pos > KEEP_RECENT) {
+		--it;
+		--pos;
+
+		int index = *it;
+		if (!IsReady(this->entries[index].png)) continue;
+
+		it = this->lru.erase(it);
+		this->Evict(index);
+	}
+}
+
+void SpriteCache::Evict(int index)
+{
+	SpriteEntry& e = this->entries[index];
+
+	PNG* png = e.png.get();
+	if (png != nullptr) delete png;
+
+	// pixels adopted from a packed entry live in its unpacked copy, an atlas sprite's in its page.
+	this->assets->ReleaseData(e.file);
+
+	DEBUGLOG << "evicted sprite " << e.file->name << ", " << e.bytes << " bytes";
+
+	this->used -= e.bytes;
+	e.bytes = 0;
+	e.png = std::shared_future<PNG*>();
+	e.lru = this->lru.end();
+}
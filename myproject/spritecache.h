@@ -0,0 +1,63 @@
+#ifndef _SPRITECACHE_H_
+#define _SPRITECACHE_H_
+
+#include <stddef.h>
+#include <list>
+#include <vector>
+
+#include "loader.h"
+#include "png.h"
+#include "vfs.h"
+
+// Sprites decoded on demand on the loader's threads and kept while they fit into a byte budget,
+// the ones shown longest ago are dropped first. Only the main thread may call into this.
+class SpriteCache {
+	// the most recently used sprites never get evicted: the one on screen and the one coming up next.
+	static const size_t KEEP_RECENT = 2;
+
+	typedef struct _sprite_entry {
+		WGFS::File* file;
+		std::shared_future<PNG*> png; // valid while loading or resident
+		size_t bytes;                 // 0 until it's known
+		bool broken;                  // didn't decode, it's never tried again
+		std::list<int>::iterator lru;
+	} SpriteEntry;
+
+	WGFS::VFS* assets;
+	AssetLoader* loader;
+	size_t budget;
+	int fitW;
+	int fitH;
+	size_t used;
+	size_t broken;
+	std::vector<SpriteEntry> entries;
+	std::list<int> lru; // front is the most recently used, holds everything loading or resident
+
+	void Touch(int index);
+	void Account();
+	void Trim();
+	void Evict(int index);
+	void Settle(SpriteEntry& e);
+
+public:
+	SpriteCache();
+	~SpriteCache();
+
+	// with a fit box every sprite is scaled to fit it (keeping its shape) once it's decoded, on
+	// the loader's threads, so what's drawn is never bigger than the box. 0 keeps them as they are.
+	void Init(WGFS::VFS* assets, AssetLoader* loader, size_t budget, int fitW = 0, int fitH = 0);
+	int Add(WGFS::File* file);
+	size_t GetCount();
+	// sprites known not to decode, the game stops picking them.
+	bool IsBroken(int index);
+	size_t GetBrokenCount();
+
+	// starts decoding the sprite if it isn't there yet, doesn't wait.
+	void Request(int index);
+	// the decoded sprite, waits when it's still being decoded. nullptr when it didn't decode.
+	PNG* Get(int index);
+
+	size_t GetUsedBytes();
+};
+
+#endif // _SPRITECACHE_H_
@@ -0,0 +1,163 @@
+#include <string.h>
+
+#include "textrun.h"
+
+void TextFormat::Parse(std::string_view format)
+{
+	this->text.assign(format);
+	this->segments.clear();
+
+	size_t literal = 0;
+	for (size_t i = 0; i < format.size(); i++) {
+		if (format[i] != '%' || i + 1 >= format.size()) continue;
+
+		char spec = format[i + 1];
+		if (spec != 'd' && spec != 's' && spec != '%') continue;
+
+		// %% keeps its second percent sign as the start of the next literal.
+		size_t literalEnd = (spec == '%') ? i + 1 : i;
+		if (literalEnd > literal)
+			this->segments.push_back({ SegmentType::LITERAL, literal, literalEnd - literal });
+
+		if (spec == 'd')
+			this->segments.push_back({ SegmentType::INT, 0, 0 });
+		else if (spec == 's')
+			this->segments.push_back({ SegmentType::STRING, 0, 0 });
+
+		literal = i + 2;
+		i++;
+	}
+
+	if (format.size() > literal)
+		this->segments.push_back({ SegmentType::LITERAL, literal, format.size() - literal });
+}
+
+TextRun::TextRun()
+{
+	this->font = nullptr;
+	this->pixelSize = 0;
+	this->effect = TextEffect::NONE;
+	this->dimm = { 0, 0 };
+	this->valid = false;
+}
+
+void TextRun::Init(Font *font, int pixelSize, TextEffect effect)
+{
+	this->font = font;
+	this->pixelSize = pixelSize;
+	this->effect = effect;
+	this->valid = false;
+	this->glyphs.reserve(128);
+}
+
+void TextRun::Begin()
+{
+	this->glyphs.clear(); // keeps the capacity
+	this->penX = 0;
+	this->penY = 0;
+	this->lineHeight = this->font->GetLineHeight(this->pixelSize);
+	this->dimm.w = 0;
+	this->dimm.h = this->lineHeight;
+}
+
+void TextRun::Append(const char *str, size_t len)
+{
+	for (size_t i = 0; i < len; i++) {
+		unsigned char c = (unsigned char)str[i];
+
+		if (c == '\n') {
+			this->penX = 0;
+			this->penY += this->lineHeight;
+			this->dimm.h += this->lineHeight;
+			continue;
+		}
+
+		const Glyph *glyph = this->font->GetGlyph(this->pixelSize, c, this->effect);
+		if (glyph == nullptr) continue;
+
+		this->glyphs.push_back({ glyph, this->penX, this->penY });
+		this->penX += glyph->advance;
+
+		// the widest line wins, same as Scene2D::CalcTextDimm
+		if (this->dimm.w < this->penX)
+			this->dimm.w = this->penX;
+	}
+}
+
+void TextRun::AppendInt(int value)
+{
+	char digits[12];
+	int n = sizeof(digits);
+	unsigned int v = value < 0 ? 0U - (unsigned int)value : (unsigned int)value;
+
+	do {
+		digits[--n] = '0' + (v % 10);
+		v /= 10;
+	} while (v != 0);
+
+	if (value < 0) digits[--n] = '-';
+
+	Append(digits + n, sizeof(digits) - n);
+}
+
+void TextRun::SetText(const char *txt)
+{
+	size_t len = strlen(txt);
+	if (this->valid && this->lastFormat == nullptr && this->lastStr == txt && this->lastLen == len) return;
+
+	Begin();
+	Append(txt, len);
+
+	this->lastFormat = nullptr;
+	this->lastStr = txt;
+	this->lastLen = len;
+	this->valid = true;
+}
+
+void TextRun::Format(const TextFormat& format, int value)
+{
+	if (this->valid && this->lastFormat == &format && this->lastInt == value) return;
+
+	const std::string& text = format.GetText();
+	Begin();
+
+	for (auto &seg : format.GetSegments()) {
+		switch (seg.type) {
+			case TextFormat::SegmentType::LITERAL: Append(text.data() + seg.start, seg.length); break;
+			case TextFormat::SegmentType::INT: AppendInt(value); break;
+			case TextFormat::SegmentType::STRING: break; // nothing to put there
+		}
+	}
+
+	this->lastFormat = &format;
+	this->lastStr = nullptr;
+	this->lastInt = value;
+	this->valid = true;
+}
+
+void TextRun::Format(const TextFormat& format, const char *str, size_t len)
+{
+	if (this->valid && this->lastFormat == &format && this->lastStr == str && this->lastLen == len) return;
+
+	const std::string& text = format.GetText();
+	Begin();
+
+	for (auto &seg : format.GetSegments()) {
+		switch (seg.type) {
+			case TextFormat::SegmentType::LITERAL: Append(text.data() + seg.start, seg.length); break;
+			case TextFormat::SegmentType::STRING: Append(str, len); break;
+			case TextFormat::SegmentType::INT: break; // nothing to put there
+		}
+	}
+
+	this->lastFormat = &format;
+	this->lastStr = str;
+	this->lastLen = len;
+	this->valid = true;
+}
+
+void TextRun::Draw(Scene2D *scene, int x, int y, Color fgColor, Color fxColor)
+{
+	for (auto &g : this->glyphs)
+		scene->DrawGlyph(g.glyph, x + g.x, y + g.y, fgColor, fxColor);
+}
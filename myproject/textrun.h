@@ -0,0 +1,82 @@
+#ifndef _TEXTRUN_H_
+#define _TEXTRUN_H_
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "graphics.h"
+#include "font.h"
+
+// A printf-style format from the string table, split into literal and argument segments once.
+// Only %d, %s and %% are understood, anything else is kept as literal text.
+class TextFormat {
+public:
+	enum class SegmentType : int {
+		LITERAL,
+		INT,
+		STRING
+	};
+
+	typedef struct _format_segment {
+		SegmentType type;
+		size_t start;  // into text, literals only
+		size_t length;
+	} Segment;
+
+	void Parse(std::string_view format);
+
+	const std::string& GetText() const { return this->text; }
+	const std::vector<Segment>& GetSegments() const { return this->segments; }
+
+private:
+	std::string text;
+	std::vector<Segment> segments;
+};
+
+// Text laid out into positioned glyphs. Layout only happens when the content changes,
+// drawing is a straight walk over the glyphs, and none of it allocates once the run
+// has grown to its longest text.
+class TextRun {
+	typedef struct _placed_glyph {
+		const Glyph *glyph;
+		int x;
+		int y;
+	} PlacedGlyph;
+
+	Font *font;
+	int pixelSize;
+	TextEffect effect;
+
+	std::vector<PlacedGlyph> glyphs;
+	TextDimm dimm;
+
+	// what the current layout was made from, so unchanged content is skipped.
+	const TextFormat *lastFormat;
+	const char *lastStr;
+	size_t lastLen;
+	int lastInt;
+	bool valid;
+
+	int penX;
+	int penY;
+	int lineHeight;
+
+	void Begin();
+	void Append(const char *str, size_t len);
+	void AppendInt(int value);
+
+public:
+	TextRun();
+
+	void Init(Font *font, int pixelSize, TextEffect effect = TextEffect::NONE);
+
+	void SetText(const char *txt);
+	void Format(const TextFormat& format, int value);
+	void Format(const TextFormat& format, const char *str, size_t len);
+
+	const TextDimm& GetDimm() const { return this->dimm; }
+	void Draw(Scene2D *scene, int x, int y, Color fgColor, Color fxColor);
+};
+
+#endif // _TEXTRUN_H_
@@ -0,0 +1,215 @@
+#include <string.h>
+
+#include "log.h"
+#include "vfs.h"
+
+namespace WGFS
+{
+	VFS::VFS()
+	{
+		this->IndexMask = 0;
+	}
+
+	VFS::~VFS()
+	{
+		// the index points into the archives, drop it first.
+		this->Index.clear();
+		this->Overridden.clear();
+		this->Mounted.clear();
+		this->Archives.clear();
+	}
+
+	bool VFS::Mount(std::unique_ptr<Assets> archive)
+	{
+		if (archive == nullptr) return false;
+
+		DEBUGLOG << "[VFS]: Mounting archive " << this->Archives.size() << " with " << archive->GetFilesAmount() << " files";
+		this->Archives.push_back(std::move(archive));
+		this->BuildIndex();
+		return true;
+	}
+
+	bool VFS::Mount(const char* filename, Storage storage)
+	{
+		auto archive = std::make_unique<Assets>();
+		bool loaded = storage == Storage::STREAMED ? archive->LoadFromFileStreamed(filename)
+			: archive->LoadFromFile(filename, storage != Storage::HEAP);
+
+		if (!loaded) {
+			DEBUGLOG << "[VFS]: Not mounting " << filename;
+			return false;
+		}
+
+		DEBUGLOG << "[VFS]: Mounting " << filename;
+		return this->Mount(std::move(archive));
+	}
+
+	size_t VFS::GetMountCount()
+	{
+		return this->Archives.size();
+	}
+
+	size_t VFS::GetArchiveSize()
+	{
+		size_t size = 0;
+		for (auto& a : this->Archives) size += a->GetArchiveSize();
+		return size;
+	}
+
+	size_t VFS::GetResidentBytes()
+	{
+		size_t resident = 0;
+		for (auto& a : this->Archives) resident += a->GetResidentBytes();
+		return resident;
+	}
+
+	void VFS::BuildIndex()
+	{
+		size_t total = 0;
+		for (auto& a : this->Archives) total += a->GetFilesAmount();
+
+		uint32_t cap = HashSlotsFor(total);
+		this->Index.assign(cap, V2_EMPTY_SLOT);
+		this->IndexMask = cap - 1;
+		this->Mounted.clear();
+		this->Mounted.reserve(total);
+		this->Overridden.assign(this->Archives.empty() ? 0 : this->Archives[0]->GetFilesAmount(), false);
+
+		// top-most archive first, a name that's already in the index is covered by a later mount.
+		for (size_t a = this->Archives.size(); a-- > 0; ) {
+			Assets* archive = this->Archives[a].get();
+
+			for (size_t f = 0; f < archive->GetFilesAmount(); f++) {
+				File* file = archive->GetFileByIndex((int)f);
+
+				uint32_t i = file->hash & this->IndexMask;
+				while (this->Index[i] != V2_EMPTY_SLOT) {
+					const File* other = this->Mounted[this->Index[i]].file;
+					if (other->hash == file->hash && strcmp(other->name, file->name) == 0) break;
+					i = (i + 1) & this->IndexMask;
+				}
+
+				if (this->Index[i] != V2_EMPTY_SLOT) {
+					if (a == 0) this->Overridden[f] = true;
+					continue;
+				}
+
+				this->Index[i] = (uint32_t)this->Mounted.size();
+				this->Mounted.push_back({ file, archive });
+			}
+		}
+
+		DEBUGLOG << "[VFS]: " << this->Mounted.size() << " files visible from " << this->Archives.size() << " archives";
+	}
+
+	const VFS::MountedFile* VFS::Find(uint32_t hash, std::string_view name)
+	{
+		if (this->Index.empty()) return nullptr;
+
+		for (uint32_t i = hash & this->IndexMask; this->Index[i] != V2_EMPTY_SLOT; i = (i + 1) & this->IndexMask) {
+			const MountedFile* m = &this->Mounted[this->Index[i]];
+			if (m->file->hash == hash && name == m->file->name) return m;
+		}
+
+		return nullptr;
+	}
+
+	File* VFS::GetFileByName(std::string_view name)
+	{
+		const MountedFile* m = this->Find(HashName(name), name);
+		if (m != nullptr) return m->file;
+
+		DEBUGLOG << "[VFS|ERROR]: Unable to find file " << name;
+		return nullptr;
+	}
+
+	File* VFS::GetFileById(const AssetId& id)
+	{
+		// ids index the base archive, and unless something is mounted over that file it's the one.
+		if (id.index < this->Overridden.size() && !this->Overridden[id.index]) {
+			File* file = this->Archives[0]->GetFileByIndex((int)id.index);
+			if (file->hash == id.hash && strcmp(file->name, id.name) == 0) return file;
+		}
+
+		// overridden, or a header that doesn't match the base archive.
+		const MountedFile* m = this->Find(id.hash, id.name);
+		if (m != nullptr) return m->file;
+
+		DEBUGLOG << "[VFS|ERROR]: Unable to find file " << id.name;
+		return nullptr;
+	}
+
+	size_t VFS::GetFilesAmount()
+	{
+		return this->Mounted.size();
+	}
+
+	Assets* VFS::GetOwner(const File* file)
+	{
+		// only a handful of archives, asking each is cheaper than keeping a map.
+		for (auto& a : this->Archives) {
+			if (a->Owns(file)) return a.get();
+		}
+
+		return nullptr;
+	}
+
+	const unsigned char* VFS::GetData(File* file)
+	{
+		Assets* owner = this->GetOwner(file);
+		return owner != nullptr ? owner->GetData(file) : nullptr;
+	}
+
+	void VFS::ReleaseData(File* file)
+	{
+		Assets* owner = this->GetOwner(file);
+		if (owner != nullptr) owner->ReleaseData(file);
+	}
+
+	void VFS::Discard(File* file)
+	{
+		Assets* owner = this->GetOwner(file);
+		if (owner != nullptr) owner->Discard(file);
+	}
+
+	bool VFS::ReadFile(const File* file, unsigned char* dst)
+	{
+		Assets* owner = this->GetOwner(file);
+		return owner != nullptr && owner->ReadFile(file, dst);
+	}
+
+	std::string_view VFS::GetString(std::string_view key)
+	{
+		std::string_view v;
+		for (size_t a = this->Archives.size(); a-- > 0; ) {
+			if (this->Archives[a]->FindString(key, &v)) return v;
+		}
+
+		return std::string_view();
+	}
+
+	std::string_view VFS::GetString(const AssetId& id)
+	{
+		// the ids index the base archive, packs on top are asked by name.
+		std::string_view v;
+		for (size_t a = this->Archives.size(); a-- > 0; ) {
+			if (a == 0 ? this->Archives[a]->FindString(id, &v) : this->Archives[a]->FindString(std::string_view(id.name), &v)) return v;
+		}
+
+		return std::string_view();
+	}
+
+#ifndef WGFS_NO_ORBIS
+	PNG* VFS::MakePNGFromFile(File* file)
+	{
+		Assets* owner = this->GetOwner(file);
+		return owner != nullptr ? owner->MakePNGFromFile(file) : nullptr;
+	}
+
+	TTFont* VFS::MakeFontFromFile(File* file, Scene2D* scene)
+	{
+		Assets* owner = this->GetOwner(file);
+		return owner != nullptr ? owner->MakeFontFromFile(file, scene) : nullptr;
+	}
+#endif
+}
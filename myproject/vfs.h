@@ -0,0 +1,70 @@
+#ifndef _VFS_H_
+#define _VFS_H_
+
+#include <stdint.h>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "wgfs.h"
+
+namespace WGFS
+{
+	// Several archives seen as one: the base data.dat, then patch and language packs mounted over
+	// it, where a later mount wins for any name it has. Mounting builds one hash index over the
+	// winners of every archive, so finding a file is a single lookup however many are mounted, and
+	// nothing in the archives below is read again or rewritten.
+	// Mount from one thread before anything else uses it, after that it's read-only like Assets.
+	class VFS {
+		typedef struct _vfs_file {
+			File* file;
+			Assets* archive; // the one that owns file
+		} MountedFile;
+
+		std::vector<std::unique_ptr<Assets>> Archives; // in mount order, the last one wins
+		std::vector<MountedFile> Mounted;
+		std::vector<uint32_t> Index; // open addressing on File::hash, index into Mounted or V2_EMPTY_SLOT
+		uint32_t IndexMask;
+		std::vector<bool> Overridden; // per base archive file, true when a pack (or a same named file) covers it
+
+		void BuildIndex();
+		const MountedFile* Find(uint32_t hash, std::string_view name);
+		Assets* GetOwner(const File* file);
+
+	public:
+		VFS();
+		~VFS();
+
+		// adds the archive on top of the ones mounted so far, false (and nothing changes) when it
+		// doesn't load. the archive must stay alive as long as this does.
+		bool Mount(std::unique_ptr<Assets> archive);
+		// storage is MAPPED, HEAP or STREAMED, see Assets::LoadFromFile(Streamed).
+		bool Mount(const char* filename, Storage storage = Storage::MAPPED);
+		size_t GetMountCount();
+		// summed over every archive, see Assets.
+		size_t GetArchiveSize();
+		size_t GetResidentBytes();
+
+		File* GetFileByName(std::string_view name);
+		// ids are hashed already, so nothing gets hashed at all.
+		File* GetFileById(const AssetId& id);
+		size_t GetFilesAmount();
+
+		// Assets' own calls, handed to whichever archive file came from.
+		const unsigned char* GetData(File* file);
+		void ReleaseData(File* file);
+		void Discard(File* file);
+		bool ReadFile(const File* file, unsigned char* dst);
+
+		// the top-most archive that has the key, a pack can override single strings.
+		std::string_view GetString(std::string_view key);
+		std::string_view GetString(const AssetId& id);
+
+#ifndef WGFS_NO_ORBIS
+		PNG* MakePNGFromFile(File* file);
+		TTFont* MakeFontFromFile(File* file, Scene2D* scene);
+#endif
+	};
+}
+
+#endif // _VFS_H_
@@ -1,30 +1,233 @@
-#include "../../_common/log.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <thread>
+
+#include "crc32c.h"
+#include "log.h"
+#include "lz4.h"
 #include "wgfs.h"
 
 
 namespace WGFS
 {
+	// unpacks the chunk at *inPos, which has to come out as exactly rawChunk bytes.
+	// src is the entry's stored bytes, size of them.
+	static bool UnpackChunk(const unsigned char* src, size_t size, size_t* inPos, unsigned char* dst, size_t rawChunk)
+	{
+		if (size - *inPos < 4) return false;
+
+		const unsigned char* p = src + *inPos;
+		uint32_t hdr = p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+		size_t stored = hdr & ~LZ4_CHUNK_RAW;
+		p += 4;
+
+		if (size - *inPos - 4 < stored) return false;
+		*inPos += 4 + stored;
+
+		if (hdr & LZ4_CHUNK_RAW) {
+			if (stored != rawChunk) return false;
+			memcpy(dst, p, stored);
+			return true;
+		}
+
+		return LZ4::DecompressBlock(p, stored, dst, rawChunk) == (int)rawChunk;
+	}
+
+	// pread until all of it is there, it may come back short or be interrupted.
+	static bool ReadAt(int fd, unsigned char* dst, size_t size, uint64_t offset)
+	{
+		while (size > 0) {
+			ssize_t got = pread(fd, dst, size, (off_t)offset);
+			if (got < 0 && errno == EINTR) continue;
+			if (got <= 0) return false;
+
+			dst += got;
+			size -= got;
+			offset += got;
+		}
+		return true;
+	}
+
+	FileReader::FileReader(const File* file)
+	{
+		this->file = file;
+		this->inPos = 0;
+		this->chunkPos = 0;
+		this->chunkSize = 0;
+		this->rawLeft = file->rawSize;
+		this->failed = file->data == nullptr && file->size != 0;
+
+		if (this->failed) DEBUGLOG << "[WGFS|ERROR]: " << file->name << " is streamed, use Assets::ReadFile";
+	}
+
+	bool FileReader::NextChunk()
+	{
+		if (this->chunk == nullptr)
+			this->chunk = std::make_unique<unsigned char[]>(LZ4_CHUNK_SIZE);
+
+		size_t raw = this->rawLeft < LZ4_CHUNK_SIZE ? this->rawLeft : LZ4_CHUNK_SIZE;
+		if (!UnpackChunk(this->file->data, this->file->size, &this->inPos, this->chunk.get(), raw)) {
+			DEBUGLOG << "[WGFS|ERROR]: Broken chunk in " << this->file->name;
+			this->failed = true;
+			return false;
+		}
+
+		this->chunkPos = 0;
+		this->chunkSize = raw;
+		this->rawLeft -= raw;
+		return true;
+	}
+
+	size_t FileReader::Read(unsigned char* dst, size_t size)
+	{
+		if (this->failed) return 0;
+
+		// plain entries are just copied out of the archive.
+		if (!(this->file->flags & ENTRY_LZ4)) {
+			size_t n = this->file->size - this->inPos;
+			if (n > size) n = size;
+
+			memcpy(dst, this->file->data + this->inPos, n);
+			this->inPos += n;
+			return n;
+		}
+
+		size_t done = 0;
+		while (done < size) {
+			if (this->chunkPos == this->chunkSize) {
+				if (this->rawLeft == 0 || !this->NextChunk()) break;
+			}
+
+			size_t n = this->chunkSize - this->chunkPos;
+			if (n > size - done) n = size - done;
+
+			memcpy(dst + done, this->chunk.get() + this->chunkPos, n);
+			this->chunkPos += n;
+			done += n;
+		}
+
+		return done;
+	}
+
+	bool FileReader::Failed()
+	{
+		return this->failed;
+	}
+
+	Assets::Assets()
+	{
+		this->Index = nullptr;
+		this->IndexMask = 0;
+		this->StringCount = 0;
+		this->StringTable = nullptr;
+		this->StringNames = nullptr;
+		this->StringSeeds = nullptr;
+		this->StringSlots = nullptr;
+		this->StringsV1 = false;
+		this->WGFSData = nullptr;
+		this->WGFSSize = 0;
+		this->DataStorage = Storage::NONE;
+		this->seek = 0;
+
+		this->DroppedBytes = 0;
+		this->EntryCrcs = false;
+		this->StreamFd = -1;
+		this->StreamTablesSize = 0;
+		this->WindowStart = 0;
+		this->WindowSize = 0;
+		this->LastReadEnd = 0;
+		this->PoolBytes = 0;
+
+		long page = sysconf(_SC_PAGESIZE);
+		this->PageSize = page > 0 ? (size_t)page : 16384;
+	}
+
 	Assets::~Assets()
 	{
 		this->Files.clear();
 		this->Files.resize(0);
 		this->Files.shrink_to_fit();
-		this->Strings.clear();
 
-		delete this->WGFSData;
+		switch (this->DataStorage) {
+			case Storage::HEAP:
+			case Storage::STREAMED: ::operator delete[]((void*)this->WGFSData, std::align_val_t(V2_DEFAULT_ALIGN)); break;
+			case Storage::MAPPED: munmap((void*)this->WGFSData, this->WGFSSize); break;
+			default: break;
+		}
+
+		if (this->StreamFd >= 0) close(this->StreamFd);
+	}
+
+	Storage Assets::GetStorage()
+	{
+		return this->DataStorage;
+	}
+
+	size_t Assets::GetArchiveSize()
+	{
+		return this->WGFSSize;
+	}
+
+	size_t Assets::GetResidentBytes()
+	{
+		// a streamed archive holds its tables and whatever's been read and not given back.
+		if (this->DataStorage == Storage::STREAMED) {
+			size_t resident = this->StreamTablesSize;
+			{
+				std::lock_guard<std::mutex> lock(this->UnpackedLock);
+				for (size_t i = 0; i < this->Unpacked.size(); i++) {
+					if (this->Unpacked[i] != nullptr) resident += this->UnpackedPooled[i];
+				}
+			}
+
+			std::lock_guard<std::mutex> lock(this->StreamLock);
+			return resident + this->PoolBytes + (this->Window != nullptr ? STREAM_READAHEAD : 0);
+		}
+
+		// a heap copy only loses what was discarded, a mapping has to be asked.
+		if (this->DataStorage != Storage::MAPPED) {
+			std::lock_guard<std::mutex> lock(this->UnpackedLock);
+			return this->WGFSSize - std::min(this->DroppedBytes, this->WGFSSize);
+		}
+
+		size_t pages = (this->WGFSSize + this->PageSize - 1) / this->PageSize;
+		std::vector<unsigned char> vec(pages);
+		if (mincore((void*)this->WGFSData, this->WGFSSize, vec.data()) != 0) return this->WGFSSize;
+
+		size_t resident = 0;
+		for (unsigned char v : vec) {
+			if (v & 1) resident += this->PageSize;
+		}
+		return std::min(resident, this->WGFSSize);
 	}
 
 	File* Assets::GetFileByIndex(int index)
 	{
-		return (this->Files[index]).get();
+		return &this->Files[index];
 	}
 
-	File* Assets::GetFileByName(const char* name)
+	File* Assets::GetFileByName(std::string_view name)
 	{
-		for (int i = 0; i < this->Files.size(); i++)
-		{
-			auto f = GetFileByIndex(i);
-			if (strcmp(name, this->Files[i]->name) == 0) return GetFileByIndex(i);
+		if (this->Index != nullptr) {
+			uint32_t hash = HashName(name);
+
+			// linear probing, the table is never more than half full so this stays short.
+			for (uint32_t n = 0, i = hash & this->IndexMask; n <= this->IndexMask; n++, i = (i + 1) & this->IndexMask) {
+				uint32_t f = this->Index[i];
+				if (f >= this->Files.size()) break; // empty slot (or junk)
+
+				const File& file = this->Files[f];
+				if (file.hash == hash && name == file.name) return GetFileByIndex(f);
+			}
 		}
 
 		DEBUGLOG << "[WGFS|ERROR]: Unable to find file " << name;
@@ -32,59 +235,712 @@ namespace WGFS
 		return nullptr;
 	}
 
+	File* Assets::GetFileById(const AssetId& id)
+	{
+		if (id.index < this->Files.size()) {
+			File* file = &this->Files[id.index];
+			if (file->hash == id.hash && strcmp(file->name, id.name) == 0) return file;
+		}
+
+		// the archive was packed without this header, search for it like anything else.
+		return this->GetFileByName(id.name);
+	}
+
+	void Assets::BuildIndex()
+	{
+		uint32_t cap = HashSlotsFor(this->Files.size());
+		this->BuiltIndex.assign(cap, V2_EMPTY_SLOT);
+		uint32_t mask = cap - 1;
+
+		for (uint32_t f = 0; f < this->Files.size(); f++) {
+			const File& file = this->Files[f];
+
+			uint32_t i = file.hash & mask;
+			while (this->BuiltIndex[i] != V2_EMPTY_SLOT) {
+				// same name twice, the first one wins like it did with the linear scan.
+				const File& other = this->Files[this->BuiltIndex[i]];
+				if (other.hash == file.hash && strcmp(other.name, file.name) == 0) break;
+				i = (i + 1) & mask;
+			}
+
+			if (this->BuiltIndex[i] == V2_EMPTY_SLOT)
+				this->BuiltIndex[i] = f;
+		}
+
+		this->Index = this->BuiltIndex.data();
+		this->IndexMask = mask;
+	}
+
 	size_t Assets::GetFilesAmount()
 	{
 		return this->Files.size();
 	}
 
+	bool Assets::ReadFile(const File* f, unsigned char* dst)
+	{
+		const unsigned char* src = f->data;
+		std::unique_ptr<unsigned char[]> staging;
+		size_t stagingSize = 0;
+
+		if (this->DataStorage == Storage::STREAMED) {
+			// plain entries go straight into dst, packed ones through a pooled buffer.
+			if (!(f->flags & ENTRY_LZ4)) return this->StreamRead(f->offset, f->size, dst) && this->CheckEntry(f, dst);
+
+			staging = this->TakeBuffer(f->size, &stagingSize);
+			if (!this->StreamRead(f->offset, f->size, staging.get())) {
+				this->GiveBuffer(std::move(staging), stagingSize);
+				return false;
+			}
+			src = staging.get();
+		}
+
+		if (!this->CheckEntry(f, src)) {
+			if (staging != nullptr) this->GiveBuffer(std::move(staging), stagingSize);
+			return false;
+		}
+
+		if (!(f->flags & ENTRY_LZ4)) {
+			memcpy(dst, src, f->size);
+			return true;
+		}
+
+		// straight into dst, no bounce through a chunk buffer.
+		bool ok = true;
+		size_t inPos = 0;
+		for (size_t out = 0; out < f->rawSize; out += LZ4_CHUNK_SIZE) {
+			size_t raw = f->rawSize - out < LZ4_CHUNK_SIZE ? f->rawSize - out : LZ4_CHUNK_SIZE;
+
+			if (!UnpackChunk(src, f->size, &inPos, dst + out, raw)) {
+				DEBUGLOG << "[WGFS|ERROR]: Broken chunk in " << f->name;
+				ok = false;
+				break;
+			}
+		}
+
+		if (staging != nullptr) this->GiveBuffer(std::move(staging), stagingSize);
+		return ok;
+	}
+
+	const unsigned char* Assets::GetData(File* f)
+	{
+		size_t i = f - this->Files.data();
+		bool discarded;
+		{
+			std::lock_guard<std::mutex> lock(this->UnpackedLock);
+			discarded = this->Discarded[i] && this->DataStorage == Storage::HEAP;
+			if (!discarded && this->Unpacked[i] != nullptr) return this->Unpacked[i].get();
+		}
+
+		// logged once the lock is gone, nothing is logged under a WGFS lock.
+		if (discarded) {
+			DEBUGLOG << "[WGFS|ERROR]: " << f->name << " was discarded!";
+			return nullptr;
+		}
+
+		if (!(f->flags & ENTRY_LZ4) && this->DataStorage != Storage::STREAMED)
+			return this->CheckEntry(f, f->data) ? f->data : nullptr;
+
+		// unpack (or read) outside the lock so different files can do so in parallel.
+		std::unique_ptr<unsigned char[]> buf;
+		size_t pooled = 0;
+		if (this->DataStorage == Storage::STREAMED) buf = this->TakeBuffer(f->rawSize, &pooled);
+		else buf.reset(new unsigned char[f->rawSize]);
+
+		if (!this->ReadFile(f, buf.get())) {
+			if (pooled != 0) this->GiveBuffer(std::move(buf), pooled);
+			return nullptr;
+		}
+
+		std::lock_guard<std::mutex> lock(this->UnpackedLock);
+		if (this->Unpacked[i] == nullptr) {
+			this->Unpacked[i] = std::move(buf);
+			this->UnpackedPooled[i] = pooled;
+		}
+		else if (pooled != 0) {
+			this->GiveBuffer(std::move(buf), pooled);
+		}
+		return this->Unpacked[i].get();
+	}
+
+	bool Assets::CheckEntry(const File* f, const unsigned char* stored)
+	{
+		if (!this->EntryCrcs) return true;
+
+		size_t i = f - this->Files.data();
+		{
+			std::lock_guard<std::mutex> lock(this->UnpackedLock);
+			if (this->Checked[i] != CHECK_PENDING) return this->Checked[i] == CHECK_GOOD;
+		}
+
+		// outside the lock, two threads may check the same entry at once but they'll agree.
+		bool good = CRC32C::Compute(stored, f->size) == f->crc;
+		if (!good) DEBUGLOG << "[WGFS|ERROR]: " << f->name << " is corrupt, its CRC doesn't match!";
+
+		std::lock_guard<std::mutex> lock(this->UnpackedLock);
+		this->Checked[i] = good ? CHECK_GOOD : CHECK_BAD;
+		return good;
+	}
+
+	size_t Assets::Verify(int threads)
+	{
+		if (!this->EntryCrcs) return 0;
+
+		std::atomic<size_t> next(0);
+		std::atomic<size_t> broken(0);
+
+		auto work = [&]() {
+			std::unique_ptr<unsigned char[]> buf;
+			size_t bufSize = 0;
+
+			for (size_t i = next++; i < this->Files.size(); i = next++) {
+				const File* f = &this->Files[i];
+				{
+					// a discarded heap entry has no bytes left to check.
+					std::lock_guard<std::mutex> lock(this->UnpackedLock);
+					if (this->Discarded[i]) continue;
+					if (this->Checked[i] != CHECK_PENDING) {
+						if (this->Checked[i] == CHECK_BAD) broken++;
+						continue;
+					}
+				}
+
+				const unsigned char* stored = f->data;
+				if (this->DataStorage == Storage::STREAMED) {
+					if (bufSize < f->size) {
+						buf.reset(new unsigned char[f->size]);
+						bufSize = f->size;
+					}
+
+					if (!this->StreamRead(f->offset, f->size, buf.get())) {
+						broken++;
+						continue;
+					}
+					stored = buf.get();
+				}
+
+				if (!this->CheckEntry(f, stored)) broken++;
+
+				// checking shouldn't leave the whole archive resident.
+				if (this->DataStorage == Storage::MAPPED) this->DropPages(f);
+			}
+		};
+
+		if (threads < 1) threads = 1;
+		std::vector<std::thread> workers;
+		for (int t = 1; t < threads; t++) workers.emplace_back(work);
+		work();
+		for (auto& t : workers) t.join();
+
+		DEBUGLOG << "[WGFS]: Verified " << this->Files.size() << " files, " << broken << " broken";
+		return broken;
+	}
+
+	bool Assets::Owns(const File* f)
+	{
+		return !this->Files.empty() && f >= this->Files.data() && f < this->Files.data() + this->Files.size();
+	}
+
+	size_t Assets::DropPages(const File* f)
+	{
+		// only the pages entirely inside the entry, the ones at its edges are shared with the
+		// entries next to it.
+		uintptr_t start = ((uintptr_t)f->data + this->PageSize - 1) & ~(uintptr_t)(this->PageSize - 1);
+		uintptr_t end = ((uintptr_t)f->data + f->size) & ~(uintptr_t)(this->PageSize - 1);
+		if (end <= start || madvise((void*)start, end - start, MADV_DONTNEED) != 0) return 0;
+		return end - start;
+	}
+
+	void Assets::ReleaseData(File* f)
+	{
+		std::unique_ptr<unsigned char[]> buf;
+		size_t pooled;
+		{
+			std::lock_guard<std::mutex> lock(this->UnpackedLock);
+			size_t i = f - this->Files.data();
+
+			// a page stays while a sprite on it still has a PNG, checked under the same lock the
+			// holds are taken with, so one made right after the last went away keeps it too.
+			if ((f->flags & ENTRY_PIXELS) && this->AtlasHolds[i] != 0) return;
+
+			buf = std::move(this->Unpacked[i]);
+			pooled = this->UnpackedPooled[i];
+			this->UnpackedPooled[i] = 0;
+		}
+
+		// streamed reads go back to the pool for the next one.
+		if (buf != nullptr && pooled != 0) this->GiveBuffer(std::move(buf), pooled);
+
+		// clean file pages, dropping them costs nothing but a read if they're wanted again.
+		if (this->DataStorage == Storage::MAPPED) this->DropPages(f);
+
+		if (!(f->flags & ENTRY_ATLAS)) return;
+
+		uint32_t holds;
+		{
+			std::lock_guard<std::mutex> lock(this->UnpackedLock);
+			size_t i = f - this->Files.data();
+			holds = this->AtlasHolds[i];
+			this->AtlasHolds[i] = 0;
+		}
+
+		AtlasRect r;
+		if (holds == 0 || !this->ReadAtlasRect(f, &r)) return;
+
+		bool last;
+		{
+			std::lock_guard<std::mutex> lock(this->UnpackedLock);
+			uint32_t& page = this->AtlasHolds[r.page];
+			page -= std::min(page, holds);
+			last = page == 0;
+		}
+
+		if (last) this->ReleaseData(&this->Files[r.page]);
+	}
+
+	bool Assets::ReadAtlasRect(const File* f, AtlasRect* r)
+	{
+		if (f->rawSize != sizeof(*r) || !this->ReadFile(f, (unsigned char*)r) || r->magic != WATL_HEADER
+			|| r->page >= this->Files.size() || !(this->Files[r->page].flags & ENTRY_PIXELS)) {
+			DEBUGLOG << "[WGFS|ERROR]: Bad atlas rect in " << f->name;
+			return false;
+		}
+		return true;
+	}
+
+	bool Assets::StreamRead(uint64_t offset, size_t size, unsigned char* dst)
+	{
+		if (offset > this->WGFSSize || this->WGFSSize - offset < size) return false;
+
+		size_t failed = 0;
+		{
+			std::lock_guard<std::mutex> lock(this->StreamLock);
+
+			if (this->Window != nullptr && offset >= this->WindowStart && offset + size <= this->WindowStart + this->WindowSize) {
+				memcpy(dst, this->Window.get() + (offset - this->WindowStart), size);
+				this->LastReadEnd = offset + size;
+				return true;
+			}
+
+			// entries are mostly asked for in archive order, so a small read right after the last one
+			// reads ahead and the next few come out of the window. big ones go straight to dst.
+			bool sequential = offset >= this->LastReadEnd && offset - this->LastReadEnd < STREAM_READAHEAD;
+			this->LastReadEnd = offset + size;
+
+			if (sequential && size <= STREAM_READAHEAD / 2) {
+				if (this->Window == nullptr) this->Window.reset(new unsigned char[STREAM_READAHEAD]);
+
+				size_t want = std::min<uint64_t>(STREAM_READAHEAD, this->WGFSSize - offset);
+				if (!ReadAt(this->StreamFd, this->Window.get(), want, offset)) {
+					this->WindowSize = 0;
+					failed = want;
+				}
+				else {
+					this->WindowStart = offset;
+					this->WindowSize = want;
+					memcpy(dst, this->Window.get(), size);
+					return true;
+				}
+			}
+		}
+
+		if (failed != 0) {
+			DEBUGLOG << "[WGFS|ERROR]: Unable to read " << failed << " bytes at " << offset;
+			return false;
+		}
+
+		if (!ReadAt(this->StreamFd, dst, size, offset)) {
+			DEBUGLOG << "[WGFS|ERROR]: Unable to read " << size << " bytes at " << offset;
+			return false;
+		}
+		return true;
+	}
+
+	std::unique_ptr<unsigned char[]> Assets::TakeBuffer(size_t size, size_t* pooledSize)
+	{
+		{
+			// the smallest one that fits.
+			std::lock_guard<std::mutex> lock(this->StreamLock);
+			size_t best = this->Pool.size();
+			for (size_t i = 0; i < this->Pool.size(); i++) {
+				if (this->Pool[i].size >= size && (best == this->Pool.size() || this->Pool[i].size < this->Pool[best].size)) best = i;
+			}
+
+			if (best != this->Pool.size()) {
+				std::unique_ptr<unsigned char[]> buffer = std::move(this->Pool[best].buffer);
+				*pooledSize = this->Pool[best].size;
+				this->PoolBytes -= *pooledSize;
+				this->Pool.erase(this->Pool.begin() + best);
+				return buffer;
+			}
+		}
+
+		// rounded up so a buffer can be reused for entries a bit bigger than the first one.
+		*pooledSize = AlignUp(size > 0 ? size : 1, 64 * 1024);
+		return std::unique_ptr<unsigned char[]>(new unsigned char[*pooledSize]);
+	}
+
+	void Assets::GiveBuffer(std::unique_ptr<unsigned char[]> buffer, size_t pooledSize)
+	{
+		std::lock_guard<std::mutex> lock(this->StreamLock);
+		if (this->PoolBytes + pooledSize > STREAM_POOL_LIMIT) return; // freed when it goes out of scope
+
+		this->PoolBytes += pooledSize;
+		this->Pool.push_back({ std::move(buffer), pooledSize });
+	}
+
+	void Assets::Discard(File* f)
+	{
+		size_t i = f - this->Files.data();
+
+		{
+			std::lock_guard<std::mutex> lock(this->UnpackedLock);
+			if (this->Discarded[i]) return;
+			this->Discarded[i] = true;
+		}
+
+		// frees the unpacked copy and gives mapped pages back.
+		this->ReleaseData(f);
+
+		if (this->DataStorage == Storage::HEAP) {
+			// anonymous pages come back zeroed, so not while another entry still shares the payload.
+			for (auto& other : this->Files) {
+				if (&other != f && other.data == f->data && other.size != 0) return;
+			}
+
+			size_t dropped = this->DropPages(f);
+
+			std::lock_guard<std::mutex> lock(this->UnpackedLock);
+			this->DroppedBytes += dropped;
+		}
+	}
+
+#ifndef WGFS_NO_ORBIS
+	static bool ReadPixelHeader(const File* f, const unsigned char* data, PixelHeader* h)
+	{
+		if (f->rawSize < sizeof(*h)) return false;
+		memcpy(h, data, sizeof(*h));
+
+		if (h->magic != WPIX_HEADER || (f->rawSize - sizeof(*h)) / 4 / (h->width ? h->width : 1) < h->height) {
+			DEBUGLOG << "[WGFS|ERROR]: Bad pixel payload in " << f->name;
+			return false;
+		}
+		return true;
+	}
+
 	PNG* Assets::MakePNGFromFile(File* f)
 	{
-		PNG* ret = new PNG(f->size, f->data);
+		if (f->flags & ENTRY_ATLAS) {
+			AtlasRect r;
+			if (!this->ReadAtlasRect(f, &r)) return nullptr;
+
+			// held before the page is touched, so releasing the last other sprite on it can't take
+			// it away in between.
+			size_t i = f - this->Files.data();
+			{
+				std::lock_guard<std::mutex> lock(this->UnpackedLock);
+				this->AtlasHolds[i]++;
+				this->AtlasHolds[r.page]++;
+			}
+
+			auto unhold = [this, i, &r]() {
+				bool last;
+				{
+					std::lock_guard<std::mutex> lock(this->UnpackedLock);
+					// a ReleaseData on the sprite meanwhile has dropped them already.
+					if (this->AtlasHolds[i] != 0) this->AtlasHolds[i]--;
+					if (this->AtlasHolds[r.page] != 0) this->AtlasHolds[r.page]--;
+					last = this->AtlasHolds[r.page] == 0;
+				}
+				if (last) this->ReleaseData(&this->Files[r.page]);
+			};
+
+			// one page for all the sprites on it, unpacked by whichever comes first.
+			File* page = &this->Files[r.page];
+			const unsigned char* pageData = this->GetData(page);
+			PixelHeader h;
+			if (pageData == nullptr || !ReadPixelHeader(page, pageData, &h)) {
+				unhold();
+				return nullptr;
+			}
+
+			if (r.x > h.width || h.width - r.x < r.width || r.y > h.height || h.height - r.y < r.height) {
+				DEBUGLOG << "[WGFS|ERROR]: " << f->name << " is outside of " << page->name;
+				unhold();
+				return nullptr;
+			}
+
+			const uint32_t* pixels = (const uint32_t*)(pageData + sizeof(h));
+			return new PNG((int)r.width, (int)r.height, pixels + (size_t)r.y * h.width + r.x, (int)h.width);
+		}
+
+		const unsigned char* data = this->GetData(f);
+		if (data == nullptr) return nullptr;
+
+		if (f->flags & ENTRY_PIXELS) {
+			// already in frame buffer format, the PNG draws straight out of the archive
+			// (or the unpacked copy, which is kept for it).
+			PixelHeader h;
+			if (!ReadPixelHeader(f, data, &h)) return nullptr;
+
+			return new PNG((int)h.width, (int)h.height, (const uint32_t*)(data + sizeof(h)));
+		}
+
+		// stb is done with the bytes once it has decoded them.
+		PNG* ret = new PNG(f->rawSize, data);
+		this->ReleaseData(f);
+
+		// callers only have to check for nullptr, not for an empty PNG.
+		PNG_INFO info = { 0, 0, 0 };
+		ret->GetInfo(&info);
+		if (info.w == 0 || info.h == 0) {
+			delete ret;
+			return nullptr;
+		}
 		return ret;
 	}
 
-	FT_Face* Assets::MakeFontFromFile(File* file, int fontSize, Scene2D* scene)
+	TTFont* Assets::MakeFontFromFile(File* file, Scene2D* scene)
 	{
-		FT_Face* ret = new FT_Face;
+		// one face for the whole file, callers add the pixel sizes they need.
+		// FreeType reads the face out of the buffer for as long as it's open, so it stays unpacked.
+		const unsigned char* data = this->GetData(file);
+		if (data == nullptr) return nullptr;
+
+		TTFont* ret = new TTFont();
 
-		if (!scene->InitMemFont(ret, file->size, file->data, fontSize))
+		if (!scene->InitMemFont(ret, file->rawSize, data)) {
 			DEBUGLOG << "font init fail!";
-		else
-			DEBUGLOG << "font init ok!";
+			delete ret;
+			return nullptr;
+		}
 
+		DEBUGLOG << "font init ok!";
 		return ret;
 	}
+#endif
 
-	std::string Assets::GetString(std::string key)
+	bool Assets::GetStringAt(size_t index, std::string_view* key, std::string_view* value)
 	{
-		return this->Strings[key];
+		if (index >= this->StringCount) return false;
+
+		if (this->StringsV1) {
+			// key\0value\0 pairs back to back, only old archives have these and they're small.
+			const char* p = (const char*)this->StringTable;
+			for (size_t i = 0; i < index * 2; i++) p += strlen(p) + 1;
+
+			*key = p;
+			*value = p + key->size() + 1;
+			return true;
+		}
+
+		V2String st;
+		memcpy(&st, this->StringTable + index * sizeof(V2String), sizeof(st));
+		*key = this->StringNames + st.keyOffset;
+		*value = this->StringNames + st.valueOffset;
+		return true;
 	}
 
-	void Assets::LoadFromMem(size_t size, unsigned char* filebuf)
+	bool Assets::FindString(std::string_view key, std::string_view* value)
 	{
-		// copy the filebuf into memory
-		this->WGFSData = new unsigned char[size];
-		memcpy(this->WGFSData, filebuf, size);
+		std::string_view k, v;
+
+		if (this->StringSeeds != nullptr) {
+			uint32_t seed = this->StringSeeds[HashName(key) % StringBuckets(this->StringCount)];
+			uint32_t i = this->StringSlots[HashSeeded(key, seed) % this->StringCount];
+
+			if (!this->GetStringAt(i, &k, &v) || k != key) return false;
+			*value = v;
+			return true;
+		}
+
+		if (this->StringsV1) {
+			// one walk over the pairs, the last of a repeated key wins.
+			bool found = false;
+			const char* p = (const char*)this->StringTable;
+			for (uint32_t i = 0; i < this->StringCount; i++) {
+				k = p;
+				v = p + k.size() + 1;
+				p = v.data() + v.size() + 1;
+
+				if (k == key) {
+					*value = v;
+					found = true;
+				}
+			}
+			return found;
+		}
+
+		// a v2 archive without the hash, from the back so the last of a repeated key wins.
+		for (size_t i = this->StringCount; i-- > 0; ) {
+			if (this->GetStringAt(i, &k, &v) && k == key) {
+				*value = v;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	bool Assets::FindString(const AssetId& id, std::string_view* value)
+	{
+		std::string_view k, v;
+		if (this->GetStringAt(id.index, &k, &v) && k == id.name) {
+			*value = v;
+			return true;
+		}
+
+		return this->FindString(std::string_view(id.name), value);
+	}
+
+	std::string_view Assets::GetString(std::string_view key)
+	{
+		std::string_view v;
+		this->FindString(key, &v);
+		return v;
+	}
+
+	std::string_view Assets::GetString(const AssetId& id)
+	{
+		std::string_view v;
+		this->FindString(id, &v);
+		return v;
+	}
+
+	size_t Assets::GetStringsAmount()
+	{
+		return this->StringCount;
+	}
+
+	bool Assets::GetStringByIndex(size_t index, std::string_view* key, std::string_view* value)
+	{
+		return this->GetStringAt(index, key, value);
+	}
+
+	bool Assets::LoadFromMem(size_t size, const unsigned char* filebuf, bool copy)
+	{
+		if (copy) {
+			// copy the filebuf into memory, aligned so v2 payloads keep their alignment.
+			unsigned char* buf = new (std::align_val_t(V2_DEFAULT_ALIGN)) unsigned char[size];
+			memcpy(buf, filebuf, size);
+
+			this->WGFSData = buf;
+			this->DataStorage = Storage::HEAP;
+		}
+		else {
+			this->WGFSData = filebuf;
+			this->DataStorage = Storage::BORROWED;
+		}
+
+		this->WGFSSize = size;
 
 		// load the stuff
-		LoadInternal();
+		return LoadInternal();
 	}
 
-	void Assets::LoadFromFile(const char* fname)
+	bool Assets::LoadFromFile(const char* fname, bool useMmap)
 	{
+		if (useMmap) {
+			int fd = open(fname, O_RDONLY);
+			struct stat st;
+
+			if (fd >= 0 && fstat(fd, &st) == 0 && st.st_size > 0) {
+				void* map = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+
+				if (map != MAP_FAILED) {
+					close(fd);
+
+					this->WGFSData = (const unsigned char*)map;
+					this->WGFSSize = st.st_size;
+					this->DataStorage = Storage::MAPPED;
+					DEBUGLOG << "[WGFS]: Mapped " << this->WGFSSize << " bytes";
+
+					// nothing is read yet, only the parts LoadInternal touches fault in.
+					return LoadInternal();
+				}
+			}
+
+			if (fd >= 0) close(fd);
+			DEBUGLOG << "[WGFS]: mmap of " << fname << " failed, reading it instead";
+		}
+
 		FILE* pFile = fopen(fname, "rb");
+		if (pFile == nullptr) {
+			DEBUGLOG << "[WGFS|ERROR]: Unable to open " << fname;
+			return false;
+		}
 		
 		// read file into memory
 		fseek(pFile, 0, SEEK_END);
 		long sFile = ftell(pFile);
-		this->WGFSData = new unsigned char[sFile];
+		if (sFile <= 0) {
+			fclose(pFile);
+			DEBUGLOG << "[WGFS|ERROR]: Unable to size " << fname;
+			return false;
+		}
+
+		unsigned char* buf = new (std::align_val_t(V2_DEFAULT_ALIGN)) unsigned char[sFile];
 		rewind(pFile);
 		DEBUGLOG << "Reading " << sFile << " bytes...";
-		fread(this->WGFSData, 1, sFile, pFile);
+		size_t got = fread(buf, 1, sFile, pFile);
 		fclose(pFile);
 
+		if (got != (size_t)sFile) {
+			::operator delete[](buf, std::align_val_t(V2_DEFAULT_ALIGN));
+			DEBUGLOG << "[WGFS|ERROR]: Read " << got << " of " << sFile << " bytes from " << fname;
+			return false;
+		}
+
+		this->WGFSData = buf;
+		this->WGFSSize = got;
+		this->DataStorage = Storage::HEAP;
+
 		// load the actual stuff.
-		LoadInternal();
+		return LoadInternal();
+	}
+
+	bool Assets::LoadFromFileStreamed(const char* fname)
+	{
+		int fd = open(fname, O_RDONLY);
+		struct stat st;
+
+		if (fd < 0 || fstat(fd, &st) != 0) {
+			if (fd >= 0) close(fd);
+			DEBUGLOG << "[WGFS|ERROR]: Unable to open " << fname;
+			return false;
+		}
+
+		// v1 keeps its tables between the payloads, there's no reading those without the rest.
+		V2Header h;
+		if ((size_t)st.st_size < sizeof(h) || !ReadAt(fd, (unsigned char*)&h, sizeof(h), 0)
+			|| h.magic != WGFS_HEADER || h.version != VERSION_2) {
+			close(fd);
+			DEBUGLOG << "[WGFS]: " << fname << " is not a v2 archive, loading it whole";
+			return LoadFromFile(fname, true);
+		}
+
+		if (h.dataOffset < sizeof(h) || h.dataOffset > (uint64_t)st.st_size) {
+			close(fd);
+			DEBUGLOG << "[WGFS|ERROR]: Invalid v2 header!";
+			return false;
+		}
+
+		// everything in front of the first payload: header, index, strings, hash and names.
+		unsigned char* buf = new (std::align_val_t(V2_DEFAULT_ALIGN)) unsigned char[h.dataOffset];
+		if (!ReadAt(fd, buf, h.dataOffset, 0)) {
+			::operator delete[](buf, std::align_val_t(V2_DEFAULT_ALIGN));
+			close(fd);
+			DEBUGLOG << "[WGFS|ERROR]: Unable to read the tables of " << fname;
+			return false;
+		}
+
+		this->WGFSData = buf;
+		this->WGFSSize = st.st_size;
+		this->StreamTablesSize = h.dataOffset;
+		this->StreamFd = fd;
+		this->DataStorage = Storage::STREAMED;
+		DEBUGLOG << "[WGFS]: Streaming " << this->WGFSSize << " bytes, " << this->StreamTablesSize << " of tables read";
+
+		return LoadInternal();
 	}
 
 	char Assets::ReadInt8()
@@ -117,9 +973,9 @@ namespace WGFS
 		return ret;
 	}
 
-	void* Assets::GetCurDataAddr()
+	const void* Assets::GetCurDataAddr()
 	{
-		return (void*)(this->WGFSData + this->seek);
+		return (const void*)(this->WGFSData + this->seek);
 	}
 
 	long Assets::SkipString()
@@ -136,63 +992,257 @@ namespace WGFS
 		return oldSeek;
 	}
 
-	void Assets::LoadInternal()
+	bool Assets::HasBytes(size_t bytes)
+	{
+		return (size_t)this->seek <= this->WGFSSize && this->WGFSSize - this->seek >= bytes;
+	}
+
+	bool Assets::HasString()
+	{
+		return (size_t)this->seek < this->WGFSSize && memchr(this->WGFSData + this->seek, 0, this->WGFSSize - this->seek) != nullptr;
+	}
+
+	bool Assets::LoadInternal()
 	{
 		DEBUGLOG << "[WGFS]: Loading file...";
 
+		this->seek = 0;
+		this->Index = nullptr;
+		this->Files.clear();
+		this->Unpacked.clear();
+		this->StringCount = 0;
+		this->StringSeeds = nullptr;
+		this->StringSlots = nullptr;
+		this->EntryCrcs = false;
+
+		if (this->WGFSSize < 8) {
+			DEBUGLOG << "[WGFS|ERROR]: File too small!";
+			return false;
+		}
+
 		int hdr = this->ReadInt32();
-		if (hdr != WGFS_HEADER) {
+		if (hdr != (int)WGFS_HEADER) {
 			DEBUGLOG << "[WGFS|ERROR]: Invalid WGFS_HEADER!";
+			return false;
 		}
 
 		int ver = this->ReadInt32();
 		DEBUGLOG << "[WGFS]: Format version " << ver;
 
+		bool ok = (ver == (int)VERSION_2) ? this->LoadV2() : this->LoadV1();
+		if (!ok) return false;
+
+		this->Unpacked.resize(this->Files.size());
+		this->UnpackedPooled.assign(this->Files.size(), 0);
+		this->Discarded.assign(this->Files.size(), false);
+		this->Checked.assign(this->Files.size(), CHECK_PENDING);
+		this->AtlasHolds.assign(this->Files.size(), 0);
+		this->DroppedBytes = 0;
+
+		DEBUGLOG << "[WGFS]: File loaded!";
+		return true;
+	}
+
+	bool Assets::LoadV1()
+	{
+		// sizes are only trusted once it's clear they fit, a cut off archive fails instead of
+		// reading past the end.
+		auto truncated = [this]() {
+			Log("LoadV1") << "[WGFS|ERROR]: Archive is cut off at " << this->seek << " of " << this->WGFSSize << " bytes!";
+			this->Files.clear();
+			return false;
+		};
+
+		if (!this->HasBytes(8)) return truncated();
+
 		int filehdr = this->ReadInt32();
-		if (filehdr != FILE_HEADER) {
+		if (filehdr != (int)FILE_HEADER) {
 			DEBUGLOG << "[WGFS|ERROR]: Invalid FILE_HEADER!";
+			return false;
 		}
 
-		int filecap = this->ReadInt32();
+		uint32_t filecap = this->ReadInt32();
 		DEBUGLOG << "[WGFS]: File table contains " << filecap << " items...";
+		this->Files.reserve(std::min<size_t>(filecap, this->WGFSSize / 5)); // a name, its NUL and a size at least
 
-		for (int i = 0; i < filecap; i++) {
-			auto f = std::make_unique<File>();
+		for (uint32_t i = 0; i < filecap; i++) {
+			File f;
 
-			f->name = (const char*)this->GetCurDataAddr();
+			if (!this->HasString()) return truncated();
+			f.name = (const char*)this->GetCurDataAddr();
 			this->SkipString();
-			f->size = this->ReadInt32();
-			f->data = (unsigned char*)this->GetCurDataAddr();
-			this->SkipBytes(f->size);
 
-			DEBUGLOG << "Adding file " << f->name;
-			this->Files.push_back(std::move(f));
+			if (!this->HasBytes(4)) return truncated();
+			f.size = (uint32_t)this->ReadInt32();
+
+			if (!this->HasBytes(f.size)) return truncated();
+			f.data = (const unsigned char*)this->GetCurDataAddr();
+			f.offset = this->SkipBytes(f.size);
+			f.hash = HashName(f.name);
+			f.rawSize = f.size;
+			f.flags = 0;
+			f.crc = 0;
+
+#ifdef WGFS_VERBOSE
+			DEBUGLOG << "Adding file " << f.name;
+#endif
+			this->Files.push_back(f);
 		}
 
+		if (!this->HasBytes(8)) return truncated();
+
 		int strghdr = this->ReadInt32();
-		if (strghdr != STRG_HEADER) {
+		if (strghdr != (int)STRG_HEADER) {
 			DEBUGLOG << "[WGFS|ERROR]: Invalid STRG_HEADER!";
+			this->Files.clear();
+			return false;
 		}
 
-		int strgcap = this->ReadInt32();
+		uint32_t strgcap = this->ReadInt32();
 		DEBUGLOG << "[WGFS]: String table contains " << strgcap << " items...";
 
-		for (int i = 0; i < strgcap; i++) {
-			char* key = (char*)this->GetCurDataAddr();
-			this->SkipString();
-			char* value = (char*)this->GetCurDataAddr();
-			this->SkipString();
-			
-			this->Strings[key] = value;
+		// nothing to build, GetString walks them where they are.
+		this->StringsV1 = true;
+		this->StringTable = (const unsigned char*)this->GetCurDataAddr();
 
-			DEBUGLOG << "[WGFS]: " << key << " | " << value;
+		for (uint32_t i = 0; i < strgcap; i++) {
+#ifdef WGFS_VERBOSE
+			DEBUGLOG << "[WGFS]: " << (const char*)this->GetCurDataAddr();
+#endif
+			if (!this->HasString()) return truncated();
+			this->SkipString(); // key
+			if (!this->HasString()) return truncated();
+			this->SkipString(); // value
 		}
 
+		this->StringCount = strgcap;
+
+		if (!this->HasBytes(4)) return truncated();
+
 		int endhdr = this->ReadInt32();
-		if (endhdr != WEND_HEADER) {
+		if (endhdr != (int)WEND_HEADER) {
 			DEBUGLOG << "[WGFS|ERROR]: Invalid WEND_HEADER!";
+			this->Files.clear();
+			return false;
 		}
 
-		DEBUGLOG << "[WGFS]: File loaded!";
+		this->BuildIndex();
+		return true;
+	}
+
+	bool Assets::LoadV2()
+	{
+		// nothing to walk, the header says where everything is.
+		V2Header h;
+		if (this->WGFSSize < sizeof(h)) {
+			DEBUGLOG << "[WGFS|ERROR]: Truncated v2 header!";
+			return false;
+		}
+		memcpy(&h, this->WGFSData, sizeof(h));
+
+		uint64_t size = this->WGFSSize;
+		if (h.archiveSize != size) {
+			DEBUGLOG << "[WGFS|ERROR]: Archive is " << size << " bytes, header says " << h.archiveSize;
+			return false;
+		}
+
+		// the tables have to be in what was loaded, a streamed archive only has those in memory.
+		uint64_t loaded = this->DataStorage == Storage::STREAMED ? this->StreamTablesSize : size;
+		bool streamed = this->DataStorage == Storage::STREAMED;
+
+		if (h.indexOffset > loaded || (loaded - h.indexOffset) / sizeof(V2Entry) < h.fileCount
+			|| h.stringsOffset > loaded || (loaded - h.stringsOffset) / sizeof(V2String) < h.stringCount
+			|| h.namesOffset > loaded || loaded - h.namesOffset < h.namesSize
+			|| h.namesSize == 0 || this->WGFSData[h.namesOffset + h.namesSize - 1] != 0
+			|| h.hashSlots == 0 || h.hashSlots < 2 * (uint64_t)h.fileCount || (h.hashSlots & (h.hashSlots - 1)) != 0
+			|| (h.hashOffset & 3) != 0 || h.hashOffset > loaded || (loaded - h.hashOffset) / sizeof(uint32_t) < h.hashSlots) {
+			DEBUGLOG << "[WGFS|ERROR]: Invalid v2 tables!";
+			return false;
+		}
+
+		// the payloads are used in place, their alignment is what the header promises.
+		if (h.alignment < V2_MIN_ALIGN || (h.alignment & (h.alignment - 1)) != 0) {
+			DEBUGLOG << "[WGFS|ERROR]: Invalid v2 alignment " << h.alignment;
+			return false;
+		}
+
+		const char* names = (const char*)this->WGFSData + h.namesOffset;
+		const unsigned char* index = this->WGFSData + h.indexOffset;
+
+		DEBUGLOG << "[WGFS]: File table contains " << h.fileCount << " items...";
+		this->Files.resize(h.fileCount);
+
+		for (uint32_t i = 0; i < h.fileCount; i++) {
+			V2Entry e;
+			memcpy(&e, index + i * sizeof(V2Entry), sizeof(e));
+
+			if (e.nameOffset >= h.namesSize || e.dataOffset > size || size - e.dataOffset < e.size
+				|| (e.dataOffset & (h.alignment - 1)) != 0
+				|| (!(e.flags & ENTRY_LZ4) && e.rawSize != e.size)) {
+				DEBUGLOG << "[WGFS|ERROR]: Entry " << i << " is out of bounds or misaligned!";
+				this->Files.clear();
+				return false;
+			}
+
+			File& f = this->Files[i];
+			f.name = names + e.nameOffset;
+			f.size = e.size;
+			f.data = streamed ? nullptr : this->WGFSData + e.dataOffset;
+			f.offset = e.dataOffset;
+			f.hash = e.nameHash;
+			f.rawSize = e.rawSize;
+			f.flags = e.flags;
+			f.crc = e.crc;
+
+#ifdef WGFS_VERBOSE
+			DEBUGLOG << "Adding file " << f.name;
+#endif
+		}
+
+		DEBUGLOG << "[WGFS]: String table contains " << h.stringCount << " items...";
+		const unsigned char* strings = this->WGFSData + h.stringsOffset;
+
+		// checked once here, after that they're used where they are.
+		for (uint32_t i = 0; i < h.stringCount; i++) {
+			V2String st;
+			memcpy(&st, strings + i * sizeof(V2String), sizeof(st));
+
+			if (st.keyOffset >= h.namesSize || st.valueOffset >= h.namesSize) {
+				DEBUGLOG << "[WGFS|ERROR]: String " << i << " is out of bounds!";
+				this->Files.clear();
+				return false;
+			}
+
+#ifdef WGFS_VERBOSE
+			DEBUGLOG << "[WGFS]: " << names + st.keyOffset << " | " << names + st.valueOffset;
+#endif
+		}
+
+		this->StringsV1 = false;
+		this->StringTable = strings;
+		this->StringNames = names;
+
+		if ((h.flags & V2_STRING_MPH) && h.stringCount > 0) {
+			uint64_t buckets = StringBuckets(h.stringCount);
+			uint64_t mphOffset = h.stringsOffset + (uint64_t)h.stringCount * sizeof(V2String);
+
+			if ((mphOffset & 3) != 0 || mphOffset > loaded || (loaded - mphOffset) / sizeof(uint32_t) < buckets + h.stringCount) {
+				DEBUGLOG << "[WGFS|ERROR]: Invalid v2 string hash!";
+				this->Files.clear();
+				return false;
+			}
+
+			this->StringSeeds = (const uint32_t*)(this->WGFSData + mphOffset);
+			this->StringSlots = this->StringSeeds + buckets;
+		}
+
+		this->StringCount = h.stringCount;
+		this->EntryCrcs = (h.flags & V2_ENTRY_CRC) != 0;
+
+		// the archive's own hash table, nothing to build.
+		this->Index = (const uint32_t*)(this->WGFSData + h.hashOffset);
+		this->IndexMask = h.hashSlots - 1;
+
+		return true;
 	}
-}
\ No newline at end of file
+}
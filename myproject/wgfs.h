@@ -1,10 +1,19 @@
 #ifndef _WGFS_H_
 #define _WGFS_H_
 
+#include <stdint.h>
+#include <memory>
 #include <vector>
-#include <unordered_map>
 #include <string>
-#include "../../_common/png.h"
+#include <string_view>
+#include <mutex>
+
+#include "wgfsformat.h"
+
+// Host tools (tools/) build the archive code with WGFS_NO_ORBIS, they have no PNG/Scene2D.
+#ifndef WGFS_NO_ORBIS
+#include "png.h"
+#endif
 
 namespace WGFS
 {
@@ -13,44 +22,182 @@ namespace WGFS
 
 	typedef struct _wgfs_file {
 		const char *name;
-		size_t size;
-		unsigned char* data;
+		size_t size; // bytes stored in the archive
+		const unsigned char* data; // read-only, may point straight into a file mapping, nullptr when streamed
+		uint64_t offset; // where data starts in the archive
+		uint32_t hash; // HashName(name)
+		size_t rawSize; // bytes once unpacked, same as size unless flags says it's packed
+		uint32_t flags; // ENTRY_* from wgfsformat.h
+		uint32_t crc; // CRC32C of the stored bytes, when the archive has them (V2_ENTRY_CRC)
 	} File;
 
+	// Reads an entry front to back, unpacking one chunk at a time, so packed entries can be
+	// streamed without ever holding all of them. Needs the archive in memory, a STREAMED one fails.
+	// It doesn't check the CRC, call Assets::Verify first when that matters.
+	class FileReader {
+		const File* file;
+		size_t inPos;
+		std::unique_ptr<unsigned char[]> chunk;
+		size_t chunkPos;
+		size_t chunkSize;
+		size_t rawLeft;
+		bool failed;
+
+		bool NextChunk();
+
+	public:
+		FileReader(const File* file);
+
+		// returns how many bytes were read, 0 at the end or when the entry is broken.
+		size_t Read(unsigned char* dst, size_t size);
+		bool Failed();
+	};
+
+	// Where the archive bytes live.
+	enum class Storage : int {
+		NONE,
+		HEAP,     // fread into our own buffer
+		MAPPED,   // read-only mmap of the file, pages come in on first touch
+		BORROWED, // caller's buffer, must outlive the Assets
+		STREAMED  // only the tables are read, payloads are pread from the file when they're asked for
+	};
+
+	// the biggest read a streamed archive does ahead of a sequential reader.
+	const size_t STREAM_READAHEAD = 256 * 1024;
+	// buffers a streamed archive keeps for reuse once they're given back, in bytes.
+	const size_t STREAM_POOL_LIMIT = 8 * 1024 * 1024;
+
 	class Assets {
-		const int WGFS_HEADER = 1397114711;
-		const int FILE_HEADER = 1162627398;
-		const int STRG_HEADER = 1196577875;
-		const int WEND_HEADER = 1145980247;
-
-		std::vector<std::unique_ptr<File>> Files;
-		std::unordered_map<std::string, std::string> Strings;
-		unsigned char* WGFSData;
+		std::vector<File> Files;
+		// open addressing name hash -> index into Files (see wgfsformat.h), v1 archives get one built
+		// at load, v2 archives carry their own and it's used in place.
+		std::vector<uint32_t> BuiltIndex;
+		const uint32_t* Index;
+		uint32_t IndexMask;
+		// strings are never copied out of the archive. v2: the V2String table and the perfect hash
+		// over it (when the packer wrote one), v1: the STRG key/value pairs, walked in place.
+		uint32_t StringCount;
+		const unsigned char* StringTable;
+		const char* StringNames;
+		const uint32_t* StringSeeds;
+		const uint32_t* StringSlots;
+		bool StringsV1;
+		std::vector<std::unique_ptr<unsigned char[]>> Unpacked; // per file, for GetData on packed (or streamed) entries
+		std::vector<size_t> UnpackedPooled; // per file, the pool size of a streamed Unpacked buffer
+		std::vector<bool> Discarded; // per file, set by Discard, under UnpackedLock too
+		enum : uint8_t { CHECK_PENDING, CHECK_GOOD, CHECK_BAD };
+		std::vector<uint8_t> Checked; // per file, CHECK_*, under UnpackedLock too
+		bool EntryCrcs; // the archive has V2_ENTRY_CRC
+		// per file, under UnpackedLock too. atlas sprites: PNGs made from it, pages: those PNGs summed
+		// over all the sprites on it, the page is released when it drops to 0.
+		std::vector<uint32_t> AtlasHolds;
+		std::mutex UnpackedLock;
+		size_t PageSize;
+		size_t DroppedBytes; // heap pages given back by Discard
+		const unsigned char* WGFSData;
+		size_t WGFSSize;
+		Storage DataStorage;
 		long seek;
 
+		// STREAMED: WGFSData only holds the tables in front of the payloads, everything else is read
+		// through the fd. Reads right after the previous one get a readahead window.
+		typedef struct _wgfs_pooled {
+			std::unique_ptr<unsigned char[]> buffer;
+			size_t size;
+		} PooledBuffer;
+
+		int StreamFd;
+		size_t StreamTablesSize;
+		std::mutex StreamLock; // the window and the pool
+		std::unique_ptr<unsigned char[]> Window;
+		uint64_t WindowStart;
+		size_t WindowSize;
+		uint64_t LastReadEnd;
+		std::vector<PooledBuffer> Pool;
+		size_t PoolBytes;
+
 		char ReadInt8();
 		short ReadInt16();
 		int ReadInt32();
 		
-		void LoadInternal();
-		void* GetCurDataAddr();
+		bool LoadInternal();
+		bool LoadV1();
+		bool LoadV2();
+		void BuildIndex();
+		const void* GetCurDataAddr();
 		long SkipString();
 		long SkipBytes(size_t bytes);
+		bool HasBytes(size_t bytes);
+		bool HasString();
+		bool GetStringAt(size_t index, std::string_view* key, std::string_view* value);
+		size_t DropPages(const File* file);
+		bool CheckEntry(const File* file, const unsigned char* stored);
+		bool ReadAtlasRect(const File* file, AtlasRect* rect);
+		bool StreamRead(uint64_t offset, size_t size, unsigned char* dst);
+		std::unique_ptr<unsigned char[]> TakeBuffer(size_t size, size_t* pooledSize);
+		void GiveBuffer(std::unique_ptr<unsigned char[]> buffer, size_t pooledSize);
 
 	public:
+		Assets();
 		~Assets(); // free all the files.
 
-		void LoadFromMem(size_t size, unsigned char* filebuf);
-		void LoadFromFile(const char* filename);
+		// copy = false uses filebuf in place, it has to stay alive as long as this does.
+		bool LoadFromMem(size_t size, const unsigned char* filebuf, bool copy = true);
+		// maps the file when it can, falls back to reading all of it.
+		bool LoadFromFile(const char* filename, bool useMmap = true);
+		// reads only the header and tables, so the archive can be bigger than the memory there is.
+		// v1 archives have their tables spread through the file and get loaded whole instead.
+		bool LoadFromFileStreamed(const char* filename);
+
+		Storage GetStorage();
+		size_t GetArchiveSize();
+		// how much of the archive is in memory right now. for a mapping that's what the OS has cached
+		// of the file, released pages stay cached until it needs the memory for something else.
+		size_t GetResidentBytes();
 
 		File* GetFileByIndex(int index);
-		File* GetFileByName(const char* name);
+		File* GetFileByName(std::string_view name);
+		// by generated ID, falls back to the name when the archive doesn't match the header.
+		File* GetFileById(const AssetId& id);
 		size_t GetFilesAmount();
-		std::string GetString(std::string key);
+		// whether file is one of ours, for when several archives are mounted together.
+		bool Owns(const File* file);
+
+		// The entry's unpacked bytes (rawSize of them). Plain entries come straight from the archive,
+		// packed (and streamed) ones are unpacked on first use and kept until ReleaseData.
+		const unsigned char* GetData(File* file);
+		// done with the entry for now: the unpacked copy is freed and, when the archive is mapped,
+		// its pages are handed back (they fault in from the file again if it's read later). an
+		// atlas sprite lets go of its page too, the page goes once no sprite on it is held.
+		void ReleaseData(File* file);
+		// done with the entry for good, e.g. once it's been decoded into something else. a heap
+		// archive gives its pages back too, GetData on it fails from then on.
+		void Discard(File* file);
+		// unpacks into dst, which has room for file->rawSize bytes.
+		bool ReadFile(const File* file, unsigned char* dst);
+
+		// An entry's CRC is checked the first time GetData or ReadFile gets to its stored bytes, a
+		// broken one fails from then on. Verify checks all the ones that haven't been yet on threads
+		// workers, for when it's better to know up front, and returns how many are broken.
+		size_t Verify(int threads);
+
+		// views into the archive, empty when there's no such key. a key that's in the table twice
+		// finds its last entry.
+		std::string_view GetString(std::string_view key);
+		std::string_view GetString(const AssetId& id);
+		// the same, but tells a missing key apart from an empty value.
+		bool FindString(std::string_view key, std::string_view* value);
+		bool FindString(const AssetId& id, std::string_view* value);
+		// all of them in archive order, for tools.
+		size_t GetStringsAmount();
+		bool GetStringByIndex(size_t index, std::string_view* key, std::string_view* value);
 
+#ifndef WGFS_NO_ORBIS
 		// OpenOrbis stuff
+		// an atlas sprite's PNG draws out of its page, which stays unpacked until ReleaseData on it.
 		PNG* MakePNGFromFile(File* file);
-		FT_Face* MakeFontFromFile(File* file, int fontSize, Scene2D* scene);
+		TTFont* MakeFontFromFile(File* file, Scene2D* scene);
+#endif
 	};
 }
 
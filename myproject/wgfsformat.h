@@ -0,0 +1,188 @@
+#ifndef _WGFSFORMAT_H_
+#define _WGFSFORMAT_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string_view>
+
+// On-disk layout of WGFS archives, shared by the game and the host tools.
+// Everything is little-endian.
+namespace WGFS
+{
+	const uint32_t WGFS_HEADER = 1397114711;
+	const uint32_t FILE_HEADER = 1162627398;
+	const uint32_t STRG_HEADER = 1196577875;
+	const uint32_t WEND_HEADER = 1145980247;
+
+	// v1:
+	//   u32 WGFS_HEADER, u32 version, u32 FILE_HEADER, u32 fileCount
+	//   fileCount * { name\0, u32 size, size bytes }
+	//   u32 STRG_HEADER, u32 stringCount, stringCount * { key\0, value\0 }, u32 WEND_HEADER
+	const uint32_t VERSION_1 = 1;
+
+	// v2:
+	//   V2Header at 0
+	//   fileCount * V2Entry at indexOffset
+	//   stringCount * V2String at stringsOffset, with V2_STRING_MPH a perfect hash over the keys right
+	//     after it: StringBuckets(stringCount) * u32 seed, then stringCount * u32 string index by slot
+	//   name pool at namesOffset, NUL terminated file names, string keys and values
+	//   hashSlots * u32 at hashOffset, entry index or V2_EMPTY_SLOT, open addressing on
+	//     nameHash & (hashSlots - 1) with linear probing, first entry with a name wins
+	//   payloads from dataOffset on, each one starting at a multiple of alignment, entries with
+	//     identical payloads may share one
+	// Offsets are from the start of the archive, so the whole thing can be used in place once mapped.
+	const uint32_t VERSION_2 = 2;
+
+	// payloads are aligned to at least this, and heap copies of archives are allocated with it.
+	const uint32_t V2_MIN_ALIGN = 16;
+	const uint32_t V2_DEFAULT_ALIGN = 64;
+
+	typedef struct _wgfs_v2_header {
+		uint32_t magic;        // WGFS_HEADER
+		uint32_t version;      // VERSION_2
+		uint32_t fileCount;
+		uint32_t stringCount;
+		uint32_t alignment;    // power of two, >= V2_MIN_ALIGN
+		uint32_t namesSize;
+		uint32_t hashSlots;    // power of two
+		uint32_t flags;        // V2_*
+		uint32_t indexOffset;  // the tables all sit in front of the payloads
+		uint32_t stringsOffset;
+		uint32_t namesOffset;
+		uint32_t hashOffset;
+		uint64_t archiveSize;  // size of the whole file, anything else is truncated
+		uint64_t dataOffset;
+	} V2Header;
+
+	const uint32_t V2_EMPTY_SLOT = 0xFFFFFFFF;
+
+	// V2Header::flags
+	const uint32_t V2_STRING_MPH = 1;
+	const uint32_t V2_ENTRY_CRC = 2; // every V2Entry::crc is set, archives from older packers have 0 there
+
+	typedef struct _wgfs_v2_entry {
+		uint32_t nameHash;     // HashName(name)
+		uint32_t nameOffset;   // into the name pool
+		uint64_t dataOffset;
+		uint32_t size;         // bytes stored in the archive
+		uint32_t rawSize;      // bytes once unpacked, same as size for plain entries
+		uint32_t flags;
+		uint32_t crc;          // CRC32C of the size stored bytes, see V2_ENTRY_CRC
+	} V2Entry;
+
+	// V2Entry::flags
+	const uint32_t ENTRY_LZ4 = 1;    // payload is LZ4 chunks, see below
+	const uint32_t ENTRY_PIXELS = 2; // a sprite decoded ahead of time, a PixelHeader and its pixels (before any LZ4)
+	const uint32_t ENTRY_ATLAS = 4;  // a sprite packed into an atlas page, the payload is its AtlasRect
+
+	// LZ4 entries are the raw bytes cut into LZ4_CHUNK_SIZE pieces (the last one shorter), each
+	// stored as a u32 header followed by that many bytes. Chunks are independent LZ4 blocks, or the
+	// raw bytes when the header has LZ4_CHUNK_RAW set, so they can be unpacked one at a time.
+	const uint32_t LZ4_CHUNK_SIZE = 64 * 1024;
+	const uint32_t LZ4_CHUNK_RAW = 0x80000000;
+
+	// ENTRY_PIXELS payloads: the header, then width * height pixels in the frame buffer's own
+	// layout (NativePixel), rows top to bottom, so they can be copied to the screen as they are.
+	const uint32_t WPIX_HEADER = 1481199703;
+	const uint32_t PIXELS_PREMULTIPLIED = 1; // colours were multiplied by alpha when packing
+
+	typedef struct _wgfs_pixel_header {
+		uint32_t magic;  // WPIX_HEADER
+		uint32_t width;
+		uint32_t height;
+		uint32_t flags;  // PIXELS_*
+	} PixelHeader;
+
+	static_assert(sizeof(PixelHeader) == 16, "PixelHeader must stay 16 bytes");
+
+	// ENTRY_ATLAS payloads: where the sprite sits in a page, an ENTRY_PIXELS entry of the same
+	// archive that holds several small sprites, so they're decoded and allocated once per page.
+	// The sprite keeps its own entry (and name and ID), only its pixels moved.
+	const uint32_t WATL_HEADER = 1280590167;
+
+	typedef struct _wgfs_atlas_rect {
+		uint32_t magic;  // WATL_HEADER
+		uint32_t page;   // entry index of the page
+		uint32_t x;
+		uint32_t y;
+		uint32_t width;
+		uint32_t height;
+	} AtlasRect;
+
+	static_assert(sizeof(AtlasRect) == 24, "AtlasRect must stay 24 bytes");
+
+	// what Scene2D writes to the frame buffer.
+	inline uint32_t NativePixel(uint8_t r, uint8_t g, uint8_t b)
+	{
+		return 0x80000000u | (r << 16) | (g << 8) | b;
+	}
+
+	typedef struct _wgfs_v2_string {
+		uint32_t keyOffset;    // into the name pool
+		uint32_t valueOffset;
+	} V2String;
+
+	static_assert(sizeof(V2Header) == 64, "V2Header must stay 64 bytes");
+	static_assert(sizeof(V2Entry) == 32, "V2Entry must stay 32 bytes");
+	static_assert(sizeof(V2String) == 8, "V2String must stay 8 bytes");
+
+	// FNV-1a, cheap and good enough for file names.
+	constexpr uint32_t HashName(std::string_view name)
+	{
+		uint32_t h = 2166136261u;
+		for (unsigned char c : name) {
+			h ^= c;
+			h *= 16777619u;
+		}
+		return h;
+	}
+
+	// The string key hash: a key goes to bucket HashName(key) % StringBuckets(count), and the
+	// bucket's seed picks its slot, HashSeeded(key, seed) % count. The packer searches for seeds
+	// that give every key its own slot, so a lookup is two hashes and one compare.
+	inline uint32_t StringBuckets(uint32_t count)
+	{
+		return count / 4 + 1;
+	}
+
+	constexpr uint32_t HashSeeded(std::string_view name, uint32_t seed)
+	{
+		uint32_t h = 2166136261u ^ (seed * 0x9E3779B9u);
+		for (unsigned char c : name) {
+			h ^= c;
+			h *= 16777619u;
+		}
+
+		// FNV's low bits are weak, mix them before they're used as a slot.
+		h ^= h >> 16;
+		h *= 0x85EBCA6Bu;
+		h ^= h >> 13;
+		h *= 0xC2B2AE35u;
+		h ^= h >> 16;
+		return h;
+	}
+
+	// slots for a hash table over count names, never more than half full.
+	inline uint32_t HashSlotsFor(size_t count)
+	{
+		uint32_t cap = 16;
+		while (cap < count * 2) cap <<= 1;
+		return cap;
+	}
+
+	inline uint64_t AlignUp(uint64_t v, uint64_t align)
+	{
+		return (v + align - 1) & ~(align - 1);
+	}
+
+	// A file or string known when the game is built, see the assetids.h wgfs-packer generates.
+	// index is where it sits in the archive (files sorted by name, strings in assets.json order)
+	// and hash its HashName, so finding it is an array index and a check instead of a search.
+	typedef struct _wgfs_asset_id {
+		uint32_t index;
+		uint32_t hash;
+		const char* name;
+	} AssetId;
+}
+
+#endif // _WGFSFORMAT_H_
@@ -0,0 +1,139 @@
+#include <stdio.h>
+
+#include "assetsjson.h"
+
+namespace
+{
+	struct Parser {
+		const std::string& text;
+		size_t pos;
+		std::string* error;
+
+		void SkipSpace()
+		{
+			while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\r' || text[pos] == '\n'))
+				pos++;
+		}
+
+		bool Fail(const char* what)
+		{
+			*error = std::string(what) + " at offset " + std::to_string(pos);
+			return false;
+		}
+
+		bool Expect(char c)
+		{
+			SkipSpace();
+			if (pos >= text.size() || text[pos] != c) return Fail((std::string("expected '") + c + "'").c_str());
+			pos++;
+			return true;
+		}
+
+		static void AppendUtf8(std::string* s, unsigned cp)
+		{
+			if (cp < 0x80) {
+				s->push_back((char)cp);
+			}
+			else if (cp < 0x800) {
+				s->push_back((char)(0xC0 | (cp >> 6)));
+				s->push_back((char)(0x80 | (cp & 0x3F)));
+			}
+			else {
+				s->push_back((char)(0xE0 | (cp >> 12)));
+				s->push_back((char)(0x80 | ((cp >> 6) & 0x3F)));
+				s->push_back((char)(0x80 | (cp & 0x3F)));
+			}
+		}
+
+		bool String(std::string* out)
+		{
+			if (!Expect('"')) return false;
+
+			while (pos < text.size()) {
+				char c = text[pos++];
+
+				if (c == '"') return true;
+				if (c != '\\') {
+					out->push_back(c);
+					continue;
+				}
+
+				if (pos >= text.size()) break;
+				char e = text[pos++];
+				switch (e) {
+					case 'n': out->push_back('\n'); break;
+					case 't': out->push_back('\t'); break;
+					case 'r': out->push_back('\r'); break;
+					case 'b': out->push_back('\b'); break;
+					case 'f': out->push_back('\f'); break;
+					case 'u': {
+						if (pos + 4 > text.size()) return Fail("truncated \\u escape");
+						unsigned cp = (unsigned)std::stoul(text.substr(pos, 4), nullptr, 16);
+						pos += 4;
+						AppendUtf8(out, cp);
+						break;
+					}
+					default: out->push_back(e); break; // \" \\ \/
+				}
+			}
+
+			return Fail("unterminated string");
+		}
+	};
+}
+
+bool ParseAssetsJson(const std::string& text, StringTable* out, std::string* error)
+{
+	Parser p = { text, 0, error };
+
+	if (!p.Expect('{')) return false;
+
+	p.SkipSpace();
+	if (p.pos < text.size() && text[p.pos] == '}') return true;
+
+	for (;;) {
+		std::string key, value;
+
+		if (!p.String(&key)) return false;
+		if (!p.Expect(':')) return false;
+		p.SkipSpace();
+		if (!p.String(&value)) return false;
+
+		out->emplace_back(std::move(key), std::move(value));
+
+		p.SkipSpace();
+		if (p.pos < text.size() && text[p.pos] == ',') {
+			p.pos++;
+			continue;
+		}
+
+		return p.Expect('}');
+	}
+}
+
+bool ReadWholeFile(const char* path, std::vector<unsigned char>* out)
+{
+	FILE* f = fopen(path, "rb");
+	if (f == nullptr) return false;
+
+	fseek(f, 0, SEEK_END);
+	long size = ftell(f);
+	rewind(f);
+
+	out->resize(size > 0 ? size : 0);
+	size_t got = size > 0 ? fread(out->data(), 1, size, f) : 0;
+	fclose(f);
+
+	return got == out->size();
+}
+
+bool LoadAssetsJson(const char* path, StringTable* out, std::string* error)
+{
+	std::vector<unsigned char> bytes;
+	if (!ReadWholeFile(path, &bytes)) {
+		*error = std::string("unable to read ") + path;
+		return false;
+	}
+
+	return ParseAssetsJson(std::string(bytes.begin(), bytes.end()), out, error);
+}
@@ -0,0 +1,17 @@
+#ifndef _ASSETSJSON_H_
+#define _ASSETSJSON_H_
+
+#include <string>
+#include <utility>
+#include <vector>
+
+// assets.json is one flat object of "key": "value" strings that ends up as the WGFS string table.
+// Entries are kept in file order so anything built from them is deterministic.
+typedef std::vector<std::pair<std::string, std::string>> StringTable;
+
+bool ParseAssetsJson(const std::string& text, StringTable* out, std::string* error);
+bool LoadAssetsJson(const char* path, StringTable* out, std::string* error);
+
+bool ReadWholeFile(const char* path, std::vector<unsigned char>* out);
+
+#endif // _ASSETSJSON_H_
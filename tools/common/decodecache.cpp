@@ -0,0 +1,45 @@
+#include <string.h>
+
+#include "decodecache.h"
+
+// "WDEC", bumped with DECODE_CACHE_VERSION whenever decoding changes so old entries are ignored.
+static const uint32_t DECODE_CACHE_MAGIC = 1128612951;
+static const uint32_t DECODE_CACHE_VERSION = 1;
+
+DecodedAsset::DecodedAsset()
+{
+	this->data = nullptr;
+	memset(&this->header, 0, sizeof(this->header));
+}
+
+bool DecodedAsset::Map(const std::string& path)
+{
+	if (!this->file.Map(path, sizeof(DecodedHeader))) return false;
+
+	memcpy(&this->header, this->file.GetData(), sizeof(this->header));
+	this->data = this->file.GetData() + sizeof(DecodedHeader);
+
+	// a file cut short by a full disk or a crash.
+	return this->header.dataSize == this->file.GetSize() - sizeof(DecodedHeader);
+}
+
+std::string DecodeCacheKey(const unsigned char* data, size_t size, uint32_t kind)
+{
+	CacheKey key((uint64_t)DECODE_CACHE_VERSION << 32 | kind);
+	key.Add(data, size);
+	return key.Hex();
+}
+
+bool DecodeCacheLoad(const std::string& dir, const std::string& key, uint32_t kind, DecodedAsset* asset)
+{
+	if (!asset->Map(CachePath(dir, key, ".wdc"))) return false;
+
+	const DecodedHeader& h = asset->header;
+	return h.magic == DECODE_CACHE_MAGIC && h.version == DECODE_CACHE_VERSION && h.kind == kind;
+}
+
+bool DecodeCacheStore(const std::string& dir, const std::string& key, uint32_t kind, uint32_t width, uint32_t height, const void* data, size_t size)
+{
+	DecodedHeader h = { DECODE_CACHE_MAGIC, DECODE_CACHE_VERSION, kind, width, height, 0, size };
+	return CacheStore(CachePath(dir, key, ".wdc"), &h, sizeof(h), data, size);
+}
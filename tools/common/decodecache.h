@@ -0,0 +1,49 @@
+#ifndef _DECODECACHE_H_
+#define _DECODECACHE_H_
+
+#include <stdint.h>
+#include <string>
+
+#include "keyedcache.h"
+
+// Decoded assets kept on disk between runs of the host tools (see keyedcache.h). An entry is keyed
+// on the bytes it was decoded from, so a run over the same archive maps what the last one decoded
+// instead of decoding it again, and a changed sprite or wav simply misses.
+
+const uint32_t DECODED_PIXELS = 1; // width * height NativePixel()s, rows top to bottom
+const uint32_t DECODED_PCM = 2;    // interleaved s16 samples
+
+typedef struct _decoded_header {
+	uint32_t magic;    // DECODE_CACHE_MAGIC
+	uint32_t version;  // DECODE_CACHE_VERSION
+	uint32_t kind;     // DECODED_*
+	uint32_t width;    // pixels: width, pcm: channels
+	uint32_t height;   // pixels: height, pcm: sample rate
+	uint32_t reserved;
+	uint64_t dataSize; // bytes after the header
+} DecodedHeader;
+
+static_assert(sizeof(DecodedHeader) == 32, "DecodedHeader must stay 32 bytes");
+
+// a decoded asset straight out of its mapped cache file.
+class DecodedAsset {
+	CacheFile file;
+
+public:
+	DecodedHeader header;
+	const unsigned char* data; // header.dataSize bytes, nullptr until loaded
+
+	DecodedAsset();
+
+	bool Map(const std::string& path);
+};
+
+// hex key for size bytes decoded as kind.
+std::string DecodeCacheKey(const unsigned char* data, size_t size, uint32_t kind);
+
+// maps the entry for key into asset, false when there's nothing (usable) there.
+bool DecodeCacheLoad(const std::string& dir, const std::string& key, uint32_t kind, DecodedAsset* asset);
+
+bool DecodeCacheStore(const std::string& dir, const std::string& key, uint32_t kind, uint32_t width, uint32_t height, const void* data, size_t size);
+
+#endif // _DECODECACHE_H_
@@ -0,0 +1,125 @@
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <filesystem>
+#include <functional>
+#include <thread>
+
+#include "keyedcache.h"
+
+static uint64_t Mix(uint64_t h)
+{
+	h ^= h >> 33;
+	h *= 0xFF51AFD7ED558CCDull;
+	h ^= h >> 33;
+	h *= 0xC4CEB9FE1A85EC53ull;
+	h ^= h >> 33;
+	return h;
+}
+
+CacheKey::CacheKey(uint64_t seed)
+{
+	this->a = 0x9E3779B97F4A7C15ull ^ seed;
+	this->b = Mix(seed + 0xC2B2AE3D27D4EB4Full);
+}
+
+void CacheKey::Add(const void* data, size_t size)
+{
+	const unsigned char* p = (const unsigned char*)data;
+	this->a = (this->a ^ size) * 0x100000001B3ull;
+
+	size_t i = 0;
+	for (; i + 8 <= size; i += 8) {
+		uint64_t w;
+		memcpy(&w, p + i, 8);
+		this->a = (this->a ^ w) * 0x100000001B3ull;
+		this->b = (this->b + w) * 0x9E3779B97F4A7C15ull;
+		this->b ^= this->b >> 29;
+	}
+
+	uint64_t tail = 0;
+	if (size > i) memcpy(&tail, p + i, size - i);
+	this->a = Mix(this->a ^ tail);
+	this->b = Mix(this->b + tail + this->a);
+}
+
+std::string CacheKey::Hex()
+{
+	char hex[33];
+	snprintf(hex, sizeof(hex), "%016llx%016llx", (unsigned long long)this->a, (unsigned long long)this->b);
+	return hex;
+}
+
+CacheFile::CacheFile()
+{
+	this->map = nullptr;
+	this->mapSize = 0;
+}
+
+CacheFile::~CacheFile()
+{
+	if (this->map != nullptr) munmap(this->map, this->mapSize);
+}
+
+bool CacheFile::Map(const std::string& path, size_t headerSize)
+{
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0) return false;
+
+	struct stat st;
+	void* map = MAP_FAILED;
+	if (fstat(fd, &st) == 0 && st.st_size > 0 && (size_t)st.st_size >= headerSize)
+		map = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if (map == MAP_FAILED) return false;
+
+	if (this->map != nullptr) munmap(this->map, this->mapSize);
+	this->map = map;
+	this->mapSize = st.st_size;
+	return true;
+}
+
+const unsigned char* CacheFile::GetData()
+{
+	return (const unsigned char*)this->map;
+}
+
+size_t CacheFile::GetSize()
+{
+	return this->mapSize;
+}
+
+std::string CachePath(const std::string& dir, const std::string& key, const char* extension)
+{
+	return (std::filesystem::path(dir) / (key + extension)).string();
+}
+
+bool CacheStore(const std::string& path, const void* header, size_t headerSize, const void* data, size_t size)
+{
+	std::error_code ec;
+	std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+	if (ec) return false;
+
+	// inputs with the same content share a key, so each thread writes a temporary of its own.
+	std::string tmp = path + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+
+	FILE* f = fopen(tmp.c_str(), "wb");
+	if (f == nullptr) return false;
+
+	bool ok = fwrite(header, headerSize, 1, f) == 1
+		&& (size == 0 || fwrite(data, 1, size, f) == size);
+	ok = fclose(f) == 0 && ok;
+
+	if (ok) {
+		std::filesystem::rename(tmp, path, ec);
+		ok = !ec;
+	}
+
+	if (!ok) std::filesystem::remove(tmp, ec);
+	return ok;
+}
@@ -0,0 +1,49 @@
+#ifndef _KEYEDCACHE_H_
+#define _KEYEDCACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+// Files named after a key in a cache directory, what wgfs-packer's entry cache and the decoded
+// asset cache are built on. Each puts its own header in front of the data and keys it on whatever
+// decides that data. Nothing in a cache directory is ever needed, it can be deleted at any time.
+
+// two 64-bit lanes fed a word at a time, 128 bits of key for a fraction of what the work it
+// stands for costs.
+class CacheKey {
+	uint64_t a;
+	uint64_t b;
+
+public:
+	explicit CacheKey(uint64_t seed);
+
+	// the size goes in as well, so one part can't run into the next.
+	void Add(const void* data, size_t size);
+	std::string Hex();
+};
+
+// a cache file mapped read-only, unmapped again when this goes away.
+class CacheFile {
+	void* map;
+	size_t mapSize;
+
+public:
+	CacheFile();
+	~CacheFile();
+	CacheFile(const CacheFile&) = delete;
+	CacheFile& operator=(const CacheFile&) = delete;
+
+	// false when it isn't there or is shorter than its header.
+	bool Map(const std::string& path, size_t headerSize);
+	const unsigned char* GetData();
+	size_t GetSize();
+};
+
+std::string CachePath(const std::string& dir, const std::string& key, const char* extension);
+
+// header then data into a temporary file that's renamed to path, so readers never see half of one.
+// the directory is made when it isn't there.
+bool CacheStore(const std::string& path, const void* header, size_t headerSize, const void* data, size_t size);
+
+#endif // _KEYEDCACHE_H_
@@ -0,0 +1,102 @@
+#include <string.h>
+
+#include "lz4compress.h"
+#include "wgfsformat.h"
+
+// the format's end of block rules: the last 5 bytes are always literals and no match may start
+// in the last 12.
+static const size_t MIN_MATCH = 4;
+static const size_t LAST_LITERALS = 5;
+static const size_t MF_LIMIT = 12;
+static const int HASH_BITS = 12;
+
+static uint32_t Read32(const uint8_t* p)
+{
+	uint32_t v;
+	memcpy(&v, p, 4);
+	return v;
+}
+
+static uint32_t Hash4(uint32_t v)
+{
+	return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+static void PutLength(std::vector<uint8_t>* out, size_t len)
+{
+	for (; len >= 255; len -= 255) out->push_back(255);
+	out->push_back((uint8_t)len);
+}
+
+static void PutSequence(std::vector<uint8_t>* out, const uint8_t* lit, size_t litLen, size_t offset, size_t matchLen)
+{
+	size_t m = matchLen >= MIN_MATCH ? matchLen - MIN_MATCH : 0;
+	out->push_back((uint8_t)(((litLen < 15 ? litLen : 15) << 4) | (m < 15 ? m : 15)));
+
+	if (litLen >= 15) PutLength(out, litLen - 15);
+	out->insert(out->end(), lit, lit + litLen);
+
+	// literals only, the end of the block.
+	if (matchLen == 0) return;
+
+	out->push_back(offset & 0xFF);
+	out->push_back((offset >> 8) & 0xFF);
+	if (m >= 15) PutLength(out, m - 15);
+}
+
+size_t LZ4CompressBlock(const uint8_t* src, size_t size, std::vector<uint8_t>* out)
+{
+	size_t start = out->size();
+	size_t anchor = 0;
+
+	if (size > MF_LIMIT) {
+		std::vector<int32_t> table((size_t)1 << HASH_BITS, -1);
+		size_t matchLimit = size - LAST_LITERALS;
+		size_t ip = 0;
+
+		while (ip + MF_LIMIT <= size) {
+			uint32_t seq = Read32(src + ip);
+			uint32_t h = Hash4(seq);
+			int32_t ref = table[h];
+			table[h] = (int32_t)ip;
+
+			if (ref < 0 || ip - ref > 65535 || Read32(src + ref) != seq) {
+				ip++;
+				continue;
+			}
+
+			size_t len = MIN_MATCH;
+			while (ip + len < matchLimit && src[ref + len] == src[ip + len]) len++;
+
+			PutSequence(out, src + anchor, ip - anchor, ip - ref, len);
+			ip += len;
+			anchor = ip;
+		}
+	}
+
+	PutSequence(out, src + anchor, size - anchor, 0, 0);
+	return out->size() - start;
+}
+
+void LZ4PackChunks(const std::vector<uint8_t>& raw, std::vector<uint8_t>* out)
+{
+	out->clear();
+	std::vector<uint8_t> block;
+
+	for (size_t pos = 0; pos < raw.size(); pos += WGFS::LZ4_CHUNK_SIZE) {
+		size_t n = raw.size() - pos < WGFS::LZ4_CHUNK_SIZE ? raw.size() - pos : WGFS::LZ4_CHUNK_SIZE;
+
+		block.clear();
+		LZ4CompressBlock(raw.data() + pos, n, &block);
+
+		uint32_t hdr = (uint32_t)block.size();
+		const uint8_t* body = block.data();
+		if (block.size() >= n) {
+			hdr = (uint32_t)n | WGFS::LZ4_CHUNK_RAW;
+			body = raw.data() + pos;
+		}
+
+		for (int i = 0; i < 4; i++) out->push_back((hdr >> (i * 8)) & 0xFF);
+		out->insert(out->end(), body, body + (hdr & ~WGFS::LZ4_CHUNK_RAW));
+	}
+}
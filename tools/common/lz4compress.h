@@ -0,0 +1,18 @@
+#ifndef _LZ4COMPRESS_H_
+#define _LZ4COMPRESS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+// The packing side of myproject/lz4.h: a greedy single-pass LZ4 block compressor. It favours
+// speed over ratio, the output is plain LZ4 any decoder understands.
+
+// Appends one block for src (at most 64KB, so every offset fits) to out, returns its size.
+size_t LZ4CompressBlock(const uint8_t* src, size_t size, std::vector<uint8_t>* out);
+
+// The WGFS chunk stream for an ENTRY_LZ4 entry (see wgfsformat.h), chunks that don't shrink
+// are stored raw.
+void LZ4PackChunks(const std::vector<uint8_t>& raw, std::vector<uint8_t>* out);
+
+#endif // _LZ4COMPRESS_H_
@@ -0,0 +1,73 @@
+#include <setjmp.h>
+#include <string.h>
+
+#include <png.h>
+
+#include "pngdecode.h"
+
+typedef struct _png_source {
+	const unsigned char* data;
+	size_t size;
+	size_t pos;
+} PngSource;
+
+static void ReadFromMemory(png_structp png, png_bytep out, png_size_t len)
+{
+	PngSource* src = (PngSource*)png_get_io_ptr(png);
+	if (src->size - src->pos < len) png_error(png, "truncated");
+
+	memcpy(out, src->data + src->pos, len);
+	src->pos += len;
+}
+
+bool DecodePNG(const std::vector<unsigned char>& data, int* w, int* h, std::vector<uint8_t>* rgba, std::string* error)
+{
+	if (data.size() < 8 || png_sig_cmp(data.data(), 0, 8) != 0) {
+		*error = "not a png";
+		return false;
+	}
+
+	png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+	png_infop info = png ? png_create_info_struct(png) : nullptr;
+	if (info == nullptr) {
+		png_destroy_read_struct(&png, nullptr, nullptr);
+		*error = "out of memory";
+		return false;
+	}
+
+	PngSource src = { data.data(), data.size(), 0 };
+	std::vector<png_bytep> rows;
+
+	if (setjmp(png_jmpbuf(png))) {
+		png_destroy_read_struct(&png, &info, nullptr);
+		*error = "corrupt png";
+		return false;
+	}
+
+	png_set_read_fn(png, &src, ReadFromMemory);
+	png_read_info(png, info);
+
+	int depth = png_get_bit_depth(png, info);
+	int type = png_get_color_type(png, info);
+
+	if (type == PNG_COLOR_TYPE_PALETTE) png_set_palette_to_rgb(png);
+	if (type == PNG_COLOR_TYPE_GRAY && depth < 8) png_set_expand_gray_1_2_4_to_8(png);
+	if (png_get_valid(png, info, PNG_INFO_tRNS)) png_set_tRNS_to_alpha(png);
+	if (depth == 16) png_set_strip_16(png);
+	if (type == PNG_COLOR_TYPE_GRAY || type == PNG_COLOR_TYPE_GRAY_ALPHA) png_set_gray_to_rgb(png);
+	png_set_filler(png, 0xFF, PNG_FILLER_AFTER);
+	png_set_interlace_handling(png);
+	png_read_update_info(png, info);
+
+	*w = (int)png_get_image_width(png, info);
+	*h = (int)png_get_image_height(png, info);
+	rgba->resize((size_t)*w * *h * 4);
+
+	rows.resize(*h);
+	for (int y = 0; y < *h; y++) rows[y] = rgba->data() + (size_t)y * *w * 4;
+
+	png_read_image(png, rows.data());
+	png_read_end(png, nullptr);
+	png_destroy_read_struct(&png, &info, nullptr);
+	return true;
+}
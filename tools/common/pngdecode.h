@@ -0,0 +1,12 @@
+#ifndef _PNGDECODE_H_
+#define _PNGDECODE_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// PNG -> 8-bit RGBA on the host with libpng, giving the same pixels stb_image does on the PS4
+// (palette, grey and tRNS expanded, 16-bit cut down to the high byte, gamma left alone).
+bool DecodePNG(const std::vector<unsigned char>& png, int* w, int* h, std::vector<uint8_t>* rgba, std::string* error);
+
+#endif // _PNGDECODE_H_
@@ -0,0 +1,267 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <unordered_map>
+
+#include "crc32c.h"
+#include "lz4compress.h"
+#include "wgfswriter.h"
+
+static void PutU32(std::vector<unsigned char>* out, uint32_t v)
+{
+	for (int i = 0; i < 4; i++) out->push_back((v >> (i * 8)) & 0xFF);
+}
+
+static void PutString(std::vector<unsigned char>* out, const std::string& s)
+{
+	out->insert(out->end(), s.begin(), s.end());
+	out->push_back(0);
+}
+
+// FNV-1a over the payload, only used to find duplicates quickly.
+static uint64_t HashPayload(const ArchiveEntry& entry)
+{
+	uint64_t h = 14695981039346656037ull;
+	for (unsigned char c : entry.data) {
+		h ^= c;
+		h *= 1099511628211ull;
+	}
+	return h;
+}
+
+bool PackEntryLZ4(ArchiveEntry* entry, double maxRatio)
+{
+	if ((entry->flags & WGFS::ENTRY_LZ4) || entry->data.empty()) return false;
+
+	std::vector<unsigned char> packed;
+	LZ4PackChunks(entry->data, &packed);
+	if (packed.size() > entry->data.size() * maxRatio) return false;
+
+	entry->rawSize = (uint32_t)entry->data.size();
+	entry->data = std::move(packed);
+	entry->flags |= WGFS::ENTRY_LZ4;
+	return true;
+}
+
+void MakePixelEntry(ArchiveEntry* entry, int w, int h, const std::vector<uint8_t>& rgba, bool premultiply)
+{
+	WGFS::PixelHeader hdr = { WGFS::WPIX_HEADER, (uint32_t)w, (uint32_t)h, premultiply ? WGFS::PIXELS_PREMULTIPLIED : 0 };
+
+	entry->data.resize(sizeof(hdr) + (size_t)w * h * 4);
+	memcpy(entry->data.data(), &hdr, sizeof(hdr));
+
+	unsigned char* out = entry->data.data() + sizeof(hdr);
+	for (size_t i = 0; i < (size_t)w * h; i++) {
+		const uint8_t* p = &rgba[i * 4];
+		uint8_t r = p[0], g = p[1], b = p[2];
+
+		if (premultiply) {
+			r = (r * p[3] + 127) / 255;
+			g = (g * p[3] + 127) / 255;
+			b = (b * p[3] + 127) / 255;
+		}
+
+		uint32_t px = WGFS::NativePixel(r, g, b);
+		memcpy(out + i * 4, &px, 4);
+	}
+
+	entry->flags |= WGFS::ENTRY_PIXELS;
+}
+
+// Seeds for the string key hash (see StringBuckets in wgfsformat.h), biggest buckets first since
+// they're the hardest to place. A key that's in the table twice finds its last entry, like the
+// old loader. false if some bucket can't be placed, the archive then goes without.
+static bool BuildStringHash(const StringTable& strings, std::vector<uint32_t>* seeds, std::vector<uint32_t>* slots)
+{
+	uint32_t count = (uint32_t)strings.size();
+	uint32_t buckets = WGFS::StringBuckets(count);
+
+	std::unordered_map<std::string, uint32_t> last;
+	for (uint32_t i = 0; i < count; i++) last[strings[i].first] = i;
+
+	std::vector<std::vector<uint32_t>> keys(buckets);
+	for (uint32_t i = 0; i < count; i++) {
+		if (last[strings[i].first] == i) keys[WGFS::HashName(strings[i].first) % buckets].push_back(i);
+	}
+
+	std::vector<uint32_t> order(buckets);
+	for (uint32_t b = 0; b < buckets; b++) order[b] = b;
+	std::stable_sort(order.begin(), order.end(), [&keys](uint32_t a, uint32_t b) { return keys[a].size() > keys[b].size(); });
+
+	seeds->assign(buckets, 0);
+	slots->assign(count, WGFS::V2_EMPTY_SLOT);
+
+	std::vector<uint32_t> taken;
+	for (uint32_t b : order) {
+		if (keys[b].empty()) break;
+
+		uint32_t seed = 0;
+		for (;; seed++) {
+			if (seed == (1u << 24)) return false;
+
+			taken.clear();
+			for (uint32_t i : keys[b]) {
+				uint32_t slot = WGFS::HashSeeded(strings[i].first, seed) % count;
+				if ((*slots)[slot] != WGFS::V2_EMPTY_SLOT || std::find(taken.begin(), taken.end(), slot) != taken.end()) break;
+				taken.push_back(slot);
+			}
+
+			if (taken.size() == keys[b].size()) break;
+		}
+
+		(*seeds)[b] = seed;
+		for (size_t k = 0; k < taken.size(); k++) (*slots)[taken[k]] = keys[b][k];
+	}
+
+	return true;
+}
+
+void WriteArchiveV1(const std::vector<ArchiveEntry>& entries, const StringTable& strings, std::vector<unsigned char>* out)
+{
+	out->clear();
+
+	PutU32(out, WGFS::WGFS_HEADER);
+	PutU32(out, WGFS::VERSION_1);
+	PutU32(out, WGFS::FILE_HEADER);
+	PutU32(out, (uint32_t)entries.size());
+
+	for (auto& e : entries) {
+		PutString(out, e.name);
+		PutU32(out, (uint32_t)e.data.size());
+		out->insert(out->end(), e.data.begin(), e.data.end());
+	}
+
+	PutU32(out, WGFS::STRG_HEADER);
+	PutU32(out, (uint32_t)strings.size());
+	for (auto& kv : strings) {
+		PutString(out, kv.first);
+		PutString(out, kv.second);
+	}
+	PutU32(out, WGFS::WEND_HEADER);
+}
+
+void WriteArchiveV2(const std::vector<ArchiveEntry>& entries, const StringTable& strings, uint32_t alignment, std::vector<unsigned char>* out)
+{
+	if (alignment < WGFS::V2_MIN_ALIGN) alignment = WGFS::V2_MIN_ALIGN;
+
+	// everything with a name goes into one pool.
+	std::string pool;
+	auto addName = [&pool](const std::string& s) {
+		uint32_t off = (uint32_t)pool.size();
+		pool += s;
+		pool.push_back(0);
+		return off;
+	};
+
+	std::vector<WGFS::V2Entry> index(entries.size());
+	std::vector<WGFS::V2String> table(strings.size());
+
+	for (size_t i = 0; i < entries.size(); i++) {
+		index[i].nameHash = WGFS::HashName(entries[i].name);
+		index[i].nameOffset = addName(entries[i].name);
+		index[i].size = (uint32_t)entries[i].data.size();
+		index[i].rawSize = (entries[i].flags & WGFS::ENTRY_LZ4) ? entries[i].rawSize : index[i].size;
+		index[i].flags = entries[i].flags;
+		index[i].crc = CRC32C::Compute(entries[i].data.data(), entries[i].data.size());
+	}
+
+	for (size_t i = 0; i < strings.size(); i++) {
+		table[i].keyOffset = addName(strings[i].first);
+		table[i].valueOffset = addName(strings[i].second);
+	}
+
+	if (pool.empty()) pool.push_back(0);
+
+	std::vector<uint32_t> seeds;
+	std::vector<uint32_t> slots;
+	bool stringHash = !strings.empty() && BuildStringHash(strings, &seeds, &slots);
+	if (!stringHash) {
+		seeds.clear();
+		slots.clear();
+	}
+
+	// the lookup table, built the same way Assets::BuildIndex does for v1.
+	uint32_t hashSlots = WGFS::HashSlotsFor(entries.size());
+	std::vector<uint32_t> hash(hashSlots, WGFS::V2_EMPTY_SLOT);
+	for (uint32_t f = 0; f < entries.size(); f++) {
+		uint32_t i = index[f].nameHash & (hashSlots - 1);
+		while (hash[i] != WGFS::V2_EMPTY_SLOT) {
+			if (index[hash[i]].nameHash == index[f].nameHash && entries[hash[i]].name == entries[f].name) break;
+			i = (i + 1) & (hashSlots - 1);
+		}
+		if (hash[i] == WGFS::V2_EMPTY_SLOT) hash[i] = f;
+	}
+
+	WGFS::V2Header h;
+	memset(&h, 0, sizeof(h));
+	h.magic = WGFS::WGFS_HEADER;
+	h.version = WGFS::VERSION_2;
+	h.fileCount = (uint32_t)entries.size();
+	h.stringCount = (uint32_t)strings.size();
+	h.alignment = alignment;
+	h.namesSize = (uint32_t)pool.size();
+	h.hashSlots = hashSlots;
+	h.flags = WGFS::V2_ENTRY_CRC | (stringHash ? WGFS::V2_STRING_MPH : 0);
+	h.indexOffset = sizeof(h);
+	h.stringsOffset = (uint32_t)(h.indexOffset + index.size() * sizeof(WGFS::V2Entry));
+	h.hashOffset = (uint32_t)(h.stringsOffset + table.size() * sizeof(WGFS::V2String) + (seeds.size() + slots.size()) * sizeof(uint32_t));
+	h.namesOffset = (uint32_t)(h.hashOffset + hash.size() * sizeof(uint32_t));
+	h.dataOffset = WGFS::AlignUp(h.namesOffset + pool.size(), alignment);
+
+	// an entry with the same bytes (and flags) as an earlier one points at that payload instead of
+	// storing it again. shared[i] is the entry whose payload i uses.
+	std::vector<size_t> shared(entries.size());
+	std::unordered_map<uint64_t, std::vector<size_t>> seen;
+	for (size_t i = 0; i < entries.size(); i++) {
+		shared[i] = i;
+
+		auto& candidates = seen[HashPayload(entries[i])];
+		for (size_t c : candidates) {
+			if (entries[c].flags == entries[i].flags && entries[c].rawSize == entries[i].rawSize && entries[c].data == entries[i].data) {
+				shared[i] = c;
+				break;
+			}
+		}
+		if (shared[i] == i) candidates.push_back(i);
+	}
+
+	uint64_t pos = h.dataOffset;
+	for (size_t i = 0; i < entries.size(); i++) {
+		if (shared[i] != i) {
+			index[i].dataOffset = index[shared[i]].dataOffset;
+			continue;
+		}
+
+		index[i].dataOffset = pos;
+		pos = WGFS::AlignUp(pos + entries[i].data.size(), alignment);
+	}
+	h.archiveSize = pos;
+
+	// padding stays zero.
+	out->assign(pos, 0);
+	memcpy(out->data(), &h, sizeof(h));
+	if (!index.empty()) memcpy(out->data() + h.indexOffset, index.data(), index.size() * sizeof(WGFS::V2Entry));
+	if (!table.empty()) memcpy(out->data() + h.stringsOffset, table.data(), table.size() * sizeof(WGFS::V2String));
+	if (stringHash) {
+		unsigned char* mph = out->data() + h.stringsOffset + table.size() * sizeof(WGFS::V2String);
+		memcpy(mph, seeds.data(), seeds.size() * sizeof(uint32_t));
+		memcpy(mph + seeds.size() * sizeof(uint32_t), slots.data(), slots.size() * sizeof(uint32_t));
+	}
+	memcpy(out->data() + h.hashOffset, hash.data(), hash.size() * sizeof(uint32_t));
+	memcpy(out->data() + h.namesOffset, pool.data(), pool.size());
+
+	for (size_t i = 0; i < entries.size(); i++) {
+		if (shared[i] == i && !entries[i].data.empty())
+			memcpy(out->data() + index[i].dataOffset, entries[i].data.data(), entries[i].data.size());
+	}
+}
+
+bool WriteWholeFile(const char* path, const std::vector<unsigned char>& data)
+{
+	FILE* f = fopen(path, "wb");
+	if (f == nullptr) return false;
+
+	size_t put = fwrite(data.data(), 1, data.size(), f);
+	return fclose(f) == 0 && put == data.size();
+}
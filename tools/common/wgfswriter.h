@@ -0,0 +1,34 @@
+#ifndef _WGFSWRITER_H_
+#define _WGFSWRITER_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "assetsjson.h"
+#include "wgfsformat.h"
+
+// Serialises WGFS archives (see myproject/wgfsformat.h). Entries and strings are written in the
+// order given, so the same input always gives the same bytes.
+typedef struct _archive_entry {
+	std::string name;
+	std::vector<unsigned char> data; // what goes in the archive
+	uint32_t flags = 0;              // WGFS::ENTRY_*
+	uint32_t rawSize = 0;            // unpacked size, only used for ENTRY_LZ4
+} ArchiveEntry;
+
+// LZ4 packs the entry when that gets it down to maxRatio of its size or less, returns whether it did.
+// Already compressed data (PNG) won't, text/TTF/WAV usually do.
+bool PackEntryLZ4(ArchiveEntry* entry, double maxRatio);
+
+// Turns the entry into an ENTRY_PIXELS payload from w * h RGBA pixels, premultiply bakes alpha into
+// the colours. Do this before PackEntryLZ4.
+void MakePixelEntry(ArchiveEntry* entry, int w, int h, const std::vector<uint8_t>& rgba, bool premultiply);
+
+// v1 has no flags, so every entry has to be plain. v2 stores identical payloads once.
+void WriteArchiveV1(const std::vector<ArchiveEntry>& entries, const StringTable& strings, std::vector<unsigned char>* out);
+void WriteArchiveV2(const std::vector<ArchiveEntry>& entries, const StringTable& strings, uint32_t alignment, std::vector<unsigned char>* out);
+
+bool WriteWholeFile(const char* path, const std::vector<unsigned char>& data);
+
+#endif // _WGFSWRITER_H_
@@ -0,0 +1,206 @@
+#include <algorithm>
+#include <string.h>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include "fontbake.h"
+
+namespace
+{
+	const uint32_t WBFN_HEADER = 1313227351;
+	const uint32_t WBFN_VERSION = 1;
+
+	typedef struct _baked_glyph {
+		uint32_t code;
+		int x, y, w, h;
+		int left, top, advance;
+		std::vector<unsigned char> pixels;
+	} BakedGlyph;
+
+	typedef struct _baked_size {
+		int pixelSize;
+		int lineHeight;
+		int ascender;
+		int atlasWidth;
+		int atlasHeight;
+		std::vector<BakedGlyph> glyphs;
+		std::vector<unsigned char> atlas;
+	} BakedSize;
+
+	void PutU32(std::vector<unsigned char>* out, size_t at, uint32_t v)
+	{
+		(*out)[at] = v & 0xFF;
+		(*out)[at + 1] = (v >> 8) & 0xFF;
+		(*out)[at + 2] = (v >> 16) & 0xFF;
+		(*out)[at + 3] = (v >> 24) & 0xFF;
+	}
+
+	void PutU16(std::vector<unsigned char>* out, size_t at, uint16_t v)
+	{
+		(*out)[at] = v & 0xFF;
+		(*out)[at + 1] = (v >> 8) & 0xFF;
+	}
+
+	// Simple shelf packer, glyphs go left to right and wrap to a new shelf.
+	// Rows are tallest-first so shelves waste as little space as possible.
+	void PackAtlas(BakedSize* s, int atlasWidth)
+	{
+		std::vector<BakedGlyph*> order;
+		for (auto& g : s->glyphs) order.push_back(&g);
+
+		std::stable_sort(order.begin(), order.end(), [](const BakedGlyph* a, const BakedGlyph* b) { return a->h > b->h; });
+
+		// a glyph that doesn't fit on a shelf by itself gets the atlas widened to it.
+		for (auto g : order) atlasWidth = std::max(atlasWidth, g->w);
+
+		int x = 0, y = 0, shelf = 0;
+		for (auto g : order) {
+			if (x > 0 && x + g->w + 1 > atlasWidth) {
+				x = 0;
+				y += shelf + 1;
+				shelf = 0;
+			}
+
+			g->x = x;
+			g->y = y;
+			x += g->w + 1;
+			shelf = std::max(shelf, g->h);
+		}
+
+		s->atlasWidth = atlasWidth;
+		s->atlasHeight = y + shelf;
+		s->atlas.assign((size_t)s->atlasWidth * s->atlasHeight, 0);
+
+		for (auto& g : s->glyphs) {
+			for (int row = 0; row < g.h; row++)
+				memcpy(&s->atlas[(size_t)(g.y + row) * s->atlasWidth + g.x], &g.pixels[(size_t)row * g.w], g.w);
+		}
+	}
+}
+
+std::string CollectCharset(const StringTable& strings, const std::vector<std::string>& names)
+{
+	bool used[256] = { };
+
+	for (const char* c = " 0123456789"; *c; c++) used[(unsigned char)*c] = true;
+	for (auto& kv : strings) for (unsigned char c : kv.second) used[c] = true;
+	for (auto& n : names) for (unsigned char c : n) used[c] = true;
+
+	std::string out;
+	for (int c = 32; c < 256; c++) {
+		if (used[c] && c != 127) out.push_back((char)c);
+	}
+
+	return out;
+}
+
+bool BakeFont(const std::vector<unsigned char>& ttf, const FontBakeOptions& options, std::vector<unsigned char>* out, std::string* error)
+{
+	FT_Library lib;
+	FT_Face face;
+
+	if (FT_Init_FreeType(&lib) != 0) {
+		*error = "FT_Init_FreeType failed";
+		return false;
+	}
+
+	if (FT_New_Memory_Face(lib, ttf.data(), (FT_Long)ttf.size(), 0, &face) != 0) {
+		*error = "FT_New_Memory_Face failed";
+		FT_Done_FreeType(lib);
+		return false;
+	}
+
+	std::vector<BakedSize> sizes;
+
+	for (int pixelSize : options.sizes) {
+		BakedSize s;
+		s.pixelSize = pixelSize;
+
+		FT_Set_Pixel_Sizes(face, 0, pixelSize);
+		s.lineHeight = (int)(face->size->metrics.height >> 6);
+		s.ascender = (int)(face->size->metrics.ascender >> 6);
+
+		for (unsigned char c : options.charset) {
+			FT_UInt index = FT_Get_Char_Index(face, c);
+			if (index == 0) continue;
+
+			if (FT_Load_Glyph(face, index, FT_LOAD_DEFAULT) != 0) continue;
+			if (FT_Render_Glyph(face->glyph, FT_RENDER_MODE_NORMAL) != 0) continue;
+
+			FT_GlyphSlot slot = face->glyph;
+			BakedGlyph g;
+			g.code = c;
+			g.x = g.y = 0;
+			g.w = (int)slot->bitmap.width;
+			g.h = (int)slot->bitmap.rows;
+			g.left = slot->bitmap_left;
+			g.top = slot->bitmap_top;
+			g.advance = (int)(slot->advance.x >> 6);
+			g.pixels.resize((size_t)g.w * g.h);
+
+			for (int row = 0; row < g.h; row++)
+				memcpy(&g.pixels[(size_t)row * g.w], slot->bitmap.buffer + row * slot->bitmap.pitch, g.w);
+
+			s.glyphs.push_back(std::move(g));
+		}
+
+		PackAtlas(&s, options.atlasWidth);
+		sizes.push_back(std::move(s));
+	}
+
+	FT_Done_Face(face);
+	FT_Done_FreeType(lib);
+
+	// header, size table, glyph tables, then the atlases.
+	size_t pos = 12 + sizes.size() * 32;
+	std::vector<size_t> glyphOffsets, atlasOffsets;
+
+	for (auto& s : sizes) {
+		glyphOffsets.push_back(pos);
+		pos += s.glyphs.size() * 20;
+	}
+
+	for (auto& s : sizes) {
+		atlasOffsets.push_back(pos);
+		pos += s.atlas.size();
+	}
+
+	out->assign(pos, 0);
+	PutU32(out, 0, WBFN_HEADER);
+	PutU32(out, 4, WBFN_VERSION);
+	PutU32(out, 8, (uint32_t)sizes.size());
+
+	for (size_t i = 0; i < sizes.size(); i++) {
+		auto& s = sizes[i];
+		size_t at = 12 + i * 32;
+
+		PutU32(out, at, s.pixelSize);
+		PutU32(out, at + 4, s.lineHeight);
+		PutU32(out, at + 8, s.ascender);
+		PutU32(out, at + 12, (uint32_t)s.glyphs.size());
+		PutU32(out, at + 16, (uint32_t)glyphOffsets[i]);
+		PutU32(out, at + 20, s.atlasWidth);
+		PutU32(out, at + 24, s.atlasHeight);
+		PutU32(out, at + 28, (uint32_t)atlasOffsets[i]);
+
+		for (size_t g = 0; g < s.glyphs.size(); g++) {
+			auto& gl = s.glyphs[g];
+			size_t e = glyphOffsets[i] + g * 20;
+
+			PutU32(out, e, gl.code);
+			PutU16(out, e + 4, gl.x);
+			PutU16(out, e + 6, gl.y);
+			PutU16(out, e + 8, gl.w);
+			PutU16(out, e + 10, gl.h);
+			PutU16(out, e + 12, (uint16_t)gl.left);
+			PutU16(out, e + 14, (uint16_t)gl.top);
+			PutU16(out, e + 16, (uint16_t)gl.advance);
+		}
+
+		if (!s.atlas.empty())
+			memcpy(out->data() + atlasOffsets[i], s.atlas.data(), s.atlas.size());
+	}
+
+	return true;
+}
@@ -0,0 +1,22 @@
+#ifndef _FONTBAKE_H_
+#define _FONTBAKE_H_
+
+#include <string>
+#include <vector>
+
+#include "../common/assetsjson.h"
+
+// Rasterises a TTF into a WBFN blob (see myproject/font.h for the layout).
+typedef struct _fontbake_options {
+	std::vector<int> sizes;  // pixel sizes, the same ones the game passes to FT_Set_Pixel_Sizes
+	std::string charset;     // every byte that should get a glyph
+	int atlasWidth = 512;
+} FontBakeOptions;
+
+bool BakeFont(const std::vector<unsigned char>& ttf, const FontBakeOptions& options, std::vector<unsigned char>* out, std::string* error);
+
+// Every character the game can put on screen: the string table values, the asset names
+// (questions are built from them) and the digits for the score.
+std::string CollectCharset(const StringTable& strings, const std::vector<std::string>& names);
+
+#endif // _FONTBAKE_H_
@@ -0,0 +1,92 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <filesystem>
+
+#include "fontbake.h"
+
+// fontbake - pre-rasterise the game font so the runtime never has to load FreeType.
+//
+//   fontbake <font.ttf> <out.wbf> [--sizes 48,24] [--strings assets.json] [--names assetdir] [--chars "extra"]
+
+static void Usage()
+{
+	fprintf(stderr, "usage: fontbake <font.ttf> <out.wbf> [--sizes 48,24] [--strings assets.json] [--names assetdir] [--chars \"extra\"]\n");
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 3) {
+		Usage();
+		return 1;
+	}
+
+	const char* ttfPath = argv[1];
+	const char* outPath = argv[2];
+
+	FontBakeOptions options;
+	StringTable strings;
+	std::vector<std::string> names;
+	std::string extra;
+	std::string error;
+
+	for (int i = 3; i < argc; i++) {
+		if (i + 1 >= argc) {
+			Usage();
+			return 1;
+		}
+
+		if (strcmp(argv[i], "--sizes") == 0) {
+			for (char* tok = strtok(argv[++i], ","); tok != nullptr; tok = strtok(nullptr, ","))
+				options.sizes.push_back(atoi(tok));
+		}
+		else if (strcmp(argv[i], "--strings") == 0) {
+			if (!LoadAssetsJson(argv[++i], &strings, &error)) {
+				fprintf(stderr, "fontbake: %s\n", error.c_str());
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "--names") == 0) {
+			for (auto& entry : std::filesystem::directory_iterator(argv[++i]))
+				names.push_back(entry.path().filename().string());
+		}
+		else if (strcmp(argv[i], "--chars") == 0) {
+			extra += argv[++i];
+		}
+		else {
+			Usage();
+			return 1;
+		}
+	}
+
+	if (options.sizes.empty()) {
+		options.sizes.push_back(48);
+		options.sizes.push_back(24);
+	}
+
+	names.push_back(extra);
+	options.charset = CollectCharset(strings, names);
+
+	std::vector<unsigned char> ttf;
+	if (!ReadWholeFile(ttfPath, &ttf)) {
+		fprintf(stderr, "fontbake: unable to read %s\n", ttfPath);
+		return 1;
+	}
+
+	std::vector<unsigned char> blob;
+	if (!BakeFont(ttf, options, &blob, &error)) {
+		fprintf(stderr, "fontbake: %s\n", error.c_str());
+		return 1;
+	}
+
+	FILE* f = fopen(outPath, "wb");
+	if (f == nullptr || fwrite(blob.data(), 1, blob.size(), f) != blob.size()) {
+		fprintf(stderr, "fontbake: unable to write %s\n", outPath);
+		return 1;
+	}
+	fclose(f);
+
+	printf("fontbake: %zu glyph(s) x %zu size(s) -> %s (%zu bytes)\n", options.charset.size(), options.sizes.size(), outPath, blob.size());
+	return 0;
+}
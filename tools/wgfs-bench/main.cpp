@@ -0,0 +1,296 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define DR_WAV_IMPLEMENTATION
+#include "dr_wav.h"
+#include "wgfs.h"
+#include "../common/decodecache.h"
+#include "../common/pngdecode.h"
+#include "../common/wgfswriter.h"
+
+// wgfs-bench - times archive loading and name lookups on synthetic archives.
+//
+//   wgfs-bench [entries...]     defaults to 10000 25000 50000 100000
+//   wgfs-bench --decode <archive.dat> [--cache dir]
+//
+// --decode times decoding every .png and .wav in a real archive the way the game does when it
+// starts, and for --pixels archives unpacking the pre-decoded sprites and atlas pages. With
+// --cache the results are kept on disk (see decodecache.h) and later runs map them.
+// It checks every entry's CRC on all cores first and times that too.
+
+typedef std::chrono::steady_clock Clock;
+
+static double Ms(Clock::time_point a, Clock::time_point b)
+{
+	return std::chrono::duration<double, std::milli>(b - a).count();
+}
+
+// count small files, named the way a big content pack would be.
+static std::vector<ArchiveEntry> MakeEntries(int count, std::vector<std::string>* names)
+{
+	std::vector<ArchiveEntry> entries(count);
+	std::mt19937 rng(1234);
+
+	for (int i = 0; i < count; i++) {
+		char name[64];
+		snprintf(name, sizeof(name), "pack%02d/sprites/thing_%06d.png", i % 37, i);
+		names->push_back(name);
+
+		entries[i].name = name;
+		entries[i].data.resize(16 + (rng() % 48));
+		for (auto& b : entries[i].data) b = rng() & 0xFF;
+	}
+
+	return entries;
+}
+
+static double TimeFileLoad(const std::vector<unsigned char>& archive, bool useMmap)
+{
+	const char* tmp = getenv("TMPDIR");
+	std::string path = std::string(tmp != nullptr ? tmp : "/tmp") + "/wgfs-bench.dat";
+	// a full or read-only temp dir would otherwise time loading nothing.
+	if (!WriteWholeFile(path.c_str(), archive)) {
+		fprintf(stderr, "wgfs-bench: unable to write %s\n", path.c_str());
+		remove(path.c_str());
+		exit(1);
+	}
+
+	bool loaded;
+	auto t0 = Clock::now();
+	{
+		WGFS::Assets assets;
+		loaded = assets.LoadFromFile(path.c_str(), useMmap);
+	}
+	auto t1 = Clock::now();
+
+	remove(path.c_str());
+	if (!loaded) {
+		fprintf(stderr, "wgfs-bench: unable to load %s back\n", path.c_str());
+		exit(1);
+	}
+
+	return Ms(t0, t1);
+}
+
+// PNG -> native pixels like PNG::MakeNative, WAV -> s16 PCM like Game::Load. Pixel entries are
+// native already, unpacking them (GetData) was the work, they're only checked and copied out.
+static bool DecodeEntry(const unsigned char* data, size_t size, uint32_t flags, uint32_t kind, uint32_t* w, uint32_t* h, std::vector<unsigned char>* out, std::string* error)
+{
+	if (flags & WGFS::ENTRY_PIXELS) {
+		WGFS::PixelHeader ph;
+		if (size < sizeof(ph)) {
+			*error = "pixel entry too small";
+			return false;
+		}
+
+		memcpy(&ph, data, sizeof(ph));
+		if (ph.magic != WGFS::WPIX_HEADER || size - sizeof(ph) != (size_t)ph.width * ph.height * 4) {
+			*error = "bad pixel header";
+			return false;
+		}
+
+		out->assign(data + sizeof(ph), data + size);
+		*w = ph.width;
+		*h = ph.height;
+		return true;
+	}
+
+	if (kind == DECODED_PIXELS) {
+		int pw, ph;
+		std::vector<uint8_t> rgba;
+		if (!DecodePNG(std::vector<unsigned char>(data, data + size), &pw, &ph, &rgba, error)) return false;
+
+		out->resize((size_t)pw * ph * 4);
+		for (size_t i = 0; i < (size_t)pw * ph; i++) {
+			uint32_t px = WGFS::NativePixel(rgba[i * 4], rgba[i * 4 + 1], rgba[i * 4 + 2]);
+			memcpy(out->data() + i * 4, &px, 4);
+		}
+
+		*w = pw;
+		*h = ph;
+		return true;
+	}
+
+	drwav wav;
+	if (!drwav_init_memory(&wav, data, size, NULL)) {
+		*error = "not a wav";
+		return false;
+	}
+
+	out->resize(wav.totalPCMFrameCount * wav.channels * sizeof(drwav_int16));
+	drwav_uint64 frames = drwav_read_pcm_frames_s16(&wav, wav.totalPCMFrameCount, (drwav_int16*)out->data());
+	out->resize(frames * wav.channels * sizeof(drwav_int16));
+
+	*w = wav.channels;
+	*h = wav.sampleRate;
+	drwav_uninit(&wav);
+	return true;
+}
+
+static int RunDecode(const char* path, const std::string& cacheDir)
+{
+	auto t0 = Clock::now();
+
+	WGFS::Assets assets;
+	if (!assets.LoadFromFile(path)) {
+		fprintf(stderr, "wgfs-bench: unable to load %s\n", path);
+		return 1;
+	}
+
+	int threads = std::max(1, (int)std::thread::hardware_concurrency());
+	auto v0 = Clock::now();
+	size_t broken = assets.Verify(threads);
+	auto v1 = Clock::now();
+	printf("%s: %zu files checked in %.2f ms on %d thread(s), %zu broken\n", path, assets.GetFilesAmount(), Ms(v0, v1), threads, broken);
+	t0 += v1 - v0;
+
+	// everything stays around until the end, like the game's sprites and samples do.
+	std::vector<std::unique_ptr<DecodedAsset>> mapped;
+	std::vector<std::vector<unsigned char>> decoded;
+	size_t hits = 0;
+	size_t bytes = 0;
+	volatile unsigned char touched = 0;
+
+	for (size_t i = 0; i < assets.GetFilesAmount(); i++) {
+		WGFS::File* f = assets.GetFileByIndex((int)i);
+		std::string name = f->name;
+
+		// an atlas sprite is only a rect, its pixels come with the page.
+		if (f->flags & WGFS::ENTRY_ATLAS) continue;
+
+		uint32_t kind;
+		if (f->flags & WGFS::ENTRY_PIXELS) kind = DECODED_PIXELS;
+		else if (name.size() > 4 && name.compare(name.size() - 4, 4, ".png") == 0) kind = DECODED_PIXELS;
+		else if (name.size() > 4 && name.compare(name.size() - 4, 4, ".wav") == 0) kind = DECODED_PCM;
+		else continue;
+
+		// keyed on the stored bytes, so a hit doesn't even unpack the entry.
+		std::string key;
+		if (!cacheDir.empty() && f->data != nullptr) {
+			key = DecodeCacheKey(f->data, f->size, kind);
+
+			auto asset = std::make_unique<DecodedAsset>();
+			if (DecodeCacheLoad(cacheDir, key, kind, asset.get())) {
+				// one byte a page, so the time includes getting it all in and not just the mmap.
+				for (size_t p = 0; p < asset->header.dataSize; p += 4096) touched = touched + asset->data[p];
+
+				hits++;
+				bytes += asset->header.dataSize;
+				mapped.push_back(std::move(asset));
+				continue;
+			}
+		}
+
+		const unsigned char* data = assets.GetData(f);
+		if (data == nullptr) continue;
+
+		uint32_t w, h;
+		std::string error;
+		decoded.emplace_back();
+		if (!DecodeEntry(data, f->rawSize, f->flags, kind, &w, &h, &decoded.back(), &error)) {
+			fprintf(stderr, "wgfs-bench: %s: %s\n", f->name, error.c_str());
+			decoded.pop_back();
+			continue;
+		}
+
+		bytes += decoded.back().size();
+		if (!key.empty() && !DecodeCacheStore(cacheDir, key, kind, w, h, decoded.back().data(), decoded.back().size()))
+			fprintf(stderr, "wgfs-bench: unable to cache %s\n", f->name);
+
+		assets.ReleaseData(f);
+	}
+
+	auto t1 = Clock::now();
+	printf("%s: %zu decoded, %zu from the cache, %zu bytes ready in %.2f ms\n", path, decoded.size(), hits, bytes, Ms(t0, t1));
+	return 0;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc >= 2 && strcmp(argv[1], "--decode") == 0) {
+		if (argc != 3 && !(argc == 5 && strcmp(argv[3], "--cache") == 0)) {
+			fprintf(stderr, "usage: wgfs-bench --decode <archive.dat> [--cache dir]\n");
+			return 1;
+		}
+
+		return RunDecode(argv[2], argc == 5 ? argv[4] : "");
+	}
+
+	std::vector<int> counts;
+	for (int i = 1; i < argc; i++) counts.push_back(atoi(argv[i]));
+	if (counts.empty()) counts = { 10000, 25000, 50000, 100000 };
+
+	std::vector<std::string> report;
+
+	for (int count : counts) {
+		std::vector<std::string> names;
+		std::vector<ArchiveEntry> entries = MakeEntries(count, &names);
+		StringTable strings = { { "title", "bench" } };
+
+		std::vector<unsigned char> archive, archiveV2;
+		WriteArchiveV1(entries, strings, &archive);
+		WriteArchiveV2(entries, strings, WGFS::V2_DEFAULT_ALIGN, &archiveV2);
+
+		WGFS::Assets assets;
+		auto t0 = Clock::now();
+		assets.LoadFromMem(archive.size(), archive.data(), false);
+		auto t1 = Clock::now();
+
+		// v2 has nothing to walk, it only fills Files from the index.
+		auto t9 = Clock::now();
+		{
+			WGFS::Assets v2;
+			v2.LoadFromMem(archiveV2.size(), archiveV2.data(), false);
+		}
+		auto t10 = Clock::now();
+
+		// every name once, in random order.
+		std::vector<std::string> order = names;
+		std::shuffle(order.begin(), order.end(), std::mt19937(99));
+
+		size_t misses = 0;
+		auto t2 = Clock::now();
+		for (auto& n : order) {
+			WGFS::File* f = assets.GetFileByName(n);
+			if (f == nullptr || n != f->name) misses++;
+		}
+		auto t3 = Clock::now();
+
+		// what GetFileByName used to do, on a sample since the full run is quadratic.
+		size_t sample = std::min<size_t>(order.size(), 1000);
+		size_t found = 0;
+		auto t4 = Clock::now();
+		for (size_t i = 0; i < sample; i++) {
+			for (size_t f = 0; f < assets.GetFilesAmount(); f++) {
+				if (strcmp(order[i].c_str(), assets.GetFileByIndex((int)f)->name) == 0) {
+					found++;
+					break;
+				}
+			}
+		}
+		auto t5 = Clock::now();
+
+		double hashedNs = Ms(t2, t3) * 1e6 / order.size();
+		double linearNs = Ms(t4, t5) * 1e6 / sample;
+
+		char line[400];
+		snprintf(line, sizeof(line), "%8d entries | load v1 %6.2f ms, v2 %6.2f ms (file v1 mmap %6.2f, fread %6.2f; v2 mmap %6.2f) | hashed %7.1f ns/lookup (%8.2f ms all) | linear %10.1f ns/lookup (~%9.1f ms all) | misses %zu",
+			count, Ms(t0, t1), Ms(t9, t10), TimeFileLoad(archive, true), TimeFileLoad(archive, false), TimeFileLoad(archiveV2, true), hashedNs, Ms(t2, t3), linearNs, linearNs * order.size() / 1e6, misses + (sample - found));
+		report.push_back(line);
+	}
+
+	printf("\n");
+	for (auto& l : report) printf("%s\n", l.c_str());
+
+	return 0;
+}
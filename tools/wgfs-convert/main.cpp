@@ -0,0 +1,146 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <sstream>
+
+#include "wgfs.h"
+#include "../common/pngdecode.h"
+#include "../common/wgfswriter.h"
+
+// wgfs-convert - rewrite a WGFS archive in another format version, v1 archives from the old
+// packer come out as v2 with an up-front index, aligned payloads and LZ4 where it pays off.
+//
+//   wgfs-convert <in.dat> <out.dat> [--version 2] [--align 64] [--lz4 0.9] [--pixels] [--premultiply]
+//
+// --lz4 is the largest packed/raw ratio worth keeping, 0 stores everything plain.
+// --pixels decodes every .png into frame buffer pixels so the game doesn't have to, they're
+// bigger than the PNG but LZ4 usually gets most of that back.
+
+static void Usage()
+{
+	fprintf(stderr, "usage: wgfs-convert <in.dat> <out.dat> [--version 1|2] [--align 64] [--lz4 maxratio] [--pixels] [--premultiply]\n");
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 3) {
+		Usage();
+		return 1;
+	}
+
+	const char* inPath = argv[1];
+	const char* outPath = argv[2];
+	int version = WGFS::VERSION_2;
+	uint32_t alignment = WGFS::V2_DEFAULT_ALIGN;
+	double maxRatio = 0.9;
+	bool pixels = false;
+	bool premultiply = false;
+
+	for (int i = 3; i < argc; i++) {
+		if (strcmp(argv[i], "--pixels") == 0) {
+			pixels = true;
+			continue;
+		}
+		else if (strcmp(argv[i], "--premultiply") == 0) {
+			premultiply = true;
+			continue;
+		}
+
+		if (i + 1 >= argc) {
+			Usage();
+			return 1;
+		}
+
+		if (strcmp(argv[i], "--version") == 0) {
+			version = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--align") == 0) {
+			alignment = (uint32_t)atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--lz4") == 0) {
+			maxRatio = atof(argv[++i]);
+		}
+		else {
+			Usage();
+			return 1;
+		}
+	}
+
+	if ((version != (int)WGFS::VERSION_1 && version != (int)WGFS::VERSION_2)
+		|| (pixels && version != (int)WGFS::VERSION_2)
+		|| alignment < WGFS::V2_MIN_ALIGN || (alignment & (alignment - 1)) != 0) {
+		Usage();
+		return 1;
+	}
+
+	// read rather than map, out may be the same file as in.
+	WGFS::Assets assets;
+	if (!assets.LoadFromFile(inPath, false)) {
+		fprintf(stderr, "wgfs-convert: unable to load %s\n", inPath);
+		return 1;
+	}
+
+	// everything gets unpacked and packed again with the new settings.
+	std::vector<ArchiveEntry> entries(assets.GetFilesAmount());
+	size_t packed = 0;
+	size_t decoded = 0;
+	for (size_t i = 0; i < entries.size(); i++) {
+		WGFS::File* f = assets.GetFileByIndex((int)i);
+		entries[i].name = f->name;
+		entries[i].data.resize(f->rawSize);
+		entries[i].flags = f->flags & ~WGFS::ENTRY_LZ4;
+
+		if (!assets.ReadFile(f, entries[i].data.data())) {
+			fprintf(stderr, "wgfs-convert: %s is broken\n", f->name);
+			return 1;
+		}
+
+		if (version == (int)WGFS::VERSION_1 && entries[i].flags != 0) {
+			fprintf(stderr, "wgfs-convert: %s can't be stored in v1\n", f->name);
+			return 1;
+		}
+
+		std::string name = entries[i].name;
+		if (pixels && !(entries[i].flags & (WGFS::ENTRY_PIXELS | WGFS::ENTRY_ATLAS)) && name.size() > 4 && name.compare(name.size() - 4, 4, ".png") == 0) {
+			int w, h;
+			std::vector<uint8_t> rgba;
+			std::string error;
+
+			if (!DecodePNG(entries[i].data, &w, &h, &rgba, &error)) {
+				fprintf(stderr, "wgfs-convert: %s: %s\n", f->name, error.c_str());
+				return 1;
+			}
+
+			MakePixelEntry(&entries[i], w, h, rgba, premultiply);
+			printf("wgfs-convert: %s decoded, %dx%d\n", f->name, w, h);
+			decoded++;
+		}
+
+		if (version == (int)WGFS::VERSION_2 && maxRatio > 0 && PackEntryLZ4(&entries[i], maxRatio)) {
+			printf("wgfs-convert: %s %u -> %zu bytes\n", f->name, entries[i].rawSize, entries[i].data.size());
+			packed++;
+		}
+	}
+
+	// same order as the input, so string IDs stay valid.
+	StringTable strings(assets.GetStringsAmount());
+	for (size_t i = 0; i < strings.size(); i++) {
+		std::string_view key, value;
+		assets.GetStringByIndex(i, &key, &value);
+		strings[i] = { std::string(key), std::string(value) };
+	}
+
+	std::vector<unsigned char> out;
+	if (version == (int)WGFS::VERSION_1) WriteArchiveV1(entries, strings, &out);
+	else WriteArchiveV2(entries, strings, alignment, &out);
+
+	if (!WriteWholeFile(outPath, out)) {
+		fprintf(stderr, "wgfs-convert: unable to write %s\n", outPath);
+		return 1;
+	}
+
+	printf("wgfs-convert: %zu file(s) (%zu decoded, %zu packed), %zu string(s) -> %s (v%d, %zu bytes)\n", entries.size(), decoded, packed, strings.size(), outPath, version, out.size());
+	return 0;
+}
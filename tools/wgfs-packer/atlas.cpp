@@ -0,0 +1,143 @@
+#include <string.h>
+
+#include <algorithm>
+#include <unordered_map>
+
+#include "atlas.h"
+
+typedef struct _atlas_sprite {
+	size_t entry;
+	uint32_t w;
+	uint32_t h;
+	uint32_t page;
+	uint32_t x;
+	uint32_t y;
+} AtlasSprite;
+
+typedef struct _atlas_shelf {
+	uint32_t page;
+	uint32_t y;
+	uint32_t h;
+	uint32_t x; // where the next sprite goes
+} AtlasShelf;
+
+typedef struct _atlas_page {
+	uint32_t w;
+	uint32_t h;
+	uint32_t flags; // PIXELS_* of the sprites in it
+} AtlasPage;
+
+size_t PackAtlas(std::vector<ArchiveEntry>* entries, uint32_t pageSize, uint32_t maxSide, size_t* pages)
+{
+	std::vector<AtlasSprite> sprites;
+	for (size_t i = 0; i < entries->size(); i++) {
+		const ArchiveEntry& e = (*entries)[i];
+		if (e.flags != WGFS::ENTRY_PIXELS || e.data.size() < sizeof(WGFS::PixelHeader)) continue;
+
+		WGFS::PixelHeader h;
+		memcpy(&h, e.data.data(), sizeof(h));
+		if (h.width == 0 || h.height == 0 || h.width > maxSide || h.height > maxSide || h.width > pageSize || h.height > pageSize) continue;
+
+		sprites.push_back({ i, h.width, h.height, 0, 0, 0 });
+	}
+
+	*pages = 0;
+	if (sprites.empty()) return 0;
+
+	// first fit decreasing height on shelves, tallest first so every shelf is as tall as the first
+	// sprite on it. pages only ever share sprites with the same pixel flags.
+	auto pixelFlags = [entries](const AtlasSprite& s) {
+		WGFS::PixelHeader h;
+		memcpy(&h, (*entries)[s.entry].data.data(), sizeof(h));
+		return h.flags;
+	};
+
+	std::stable_sort(sprites.begin(), sprites.end(), [entries](const AtlasSprite& a, const AtlasSprite& b) {
+		if (a.h != b.h) return a.h > b.h;
+		if (a.w != b.w) return a.w > b.w;
+		return (*entries)[a.entry].name < (*entries)[b.entry].name;
+	});
+
+	std::vector<AtlasShelf> shelves;
+	std::vector<AtlasPage> pageList;
+	for (auto& s : sprites) {
+		uint32_t flags = pixelFlags(s);
+
+		AtlasShelf* shelf = nullptr;
+		for (auto& sh : shelves) {
+			if (pageList[sh.page].flags == flags && sh.h >= s.h && pageSize - sh.x >= s.w) {
+				shelf = &sh;
+				break;
+			}
+		}
+
+		if (shelf == nullptr) {
+			uint32_t page = (uint32_t)pageList.size();
+			for (uint32_t p = 0; p < pageList.size(); p++) {
+				if (pageList[p].flags == flags && pageSize - pageList[p].h >= s.h) {
+					page = p;
+					break;
+				}
+			}
+
+			if (page == pageList.size()) pageList.push_back({ 0, 0, flags });
+
+			shelves.push_back({ page, pageList[page].h, s.h, 0 });
+			pageList[page].h += s.h;
+			shelf = &shelves.back();
+		}
+
+		s.page = shelf->page;
+		s.x = shelf->x;
+		s.y = shelf->y;
+		shelf->x += s.w;
+		pageList[s.page].w = std::max(pageList[s.page].w, shelf->x);
+	}
+
+	// copy the pixels over, the gaps stay transparent black.
+	size_t first = entries->size();
+	for (size_t p = 0; p < pageList.size(); p++) {
+		WGFS::PixelHeader h = { WGFS::WPIX_HEADER, pageList[p].w, pageList[p].h, pageList[p].flags };
+
+		ArchiveEntry page;
+		page.name = "@atlas/" + std::to_string(p);
+		page.flags = WGFS::ENTRY_PIXELS;
+		page.data.assign(sizeof(h) + (size_t)h.width * h.height * 4, 0);
+		memcpy(page.data.data(), &h, sizeof(h));
+		entries->push_back(std::move(page));
+	}
+
+	for (auto& s : sprites) {
+		ArchiveEntry& e = (*entries)[s.entry];
+		ArchiveEntry& page = (*entries)[first + s.page];
+		uint32_t pageW = pageList[s.page].w;
+
+		for (uint32_t row = 0; row < s.h; row++) {
+			memcpy(page.data.data() + sizeof(WGFS::PixelHeader) + ((size_t)(s.y + row) * pageW + s.x) * 4,
+				e.data.data() + sizeof(WGFS::PixelHeader) + (size_t)row * s.w * 4, (size_t)s.w * 4);
+		}
+
+		// the page index is filled in once everything is sorted.
+		WGFS::AtlasRect r = { WGFS::WATL_HEADER, s.page, s.x, s.y, s.w, s.h };
+		e.data.resize(sizeof(r));
+		memcpy(e.data.data(), &r, sizeof(r));
+		e.flags = WGFS::ENTRY_ATLAS;
+	}
+
+	std::stable_sort(entries->begin(), entries->end(), [](const ArchiveEntry& a, const ArchiveEntry& b) { return a.name < b.name; });
+
+	std::unordered_map<std::string, uint32_t> index;
+	for (size_t i = 0; i < entries->size(); i++) index[(*entries)[i].name] = (uint32_t)i;
+
+	for (auto& e : *entries) {
+		if (e.flags != WGFS::ENTRY_ATLAS) continue;
+
+		WGFS::AtlasRect r;
+		memcpy(&r, e.data.data(), sizeof(r));
+		r.page = index["@atlas/" + std::to_string(r.page)];
+		memcpy(e.data.data(), &r, sizeof(r));
+	}
+
+	*pages = pageList.size();
+	return sprites.size();
+}
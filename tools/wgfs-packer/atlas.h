@@ -0,0 +1,17 @@
+#ifndef _ATLAS_H_
+#define _ATLAS_H_
+
+#include <stdint.h>
+#include <vector>
+
+#include "../common/wgfswriter.h"
+
+// Moves the pixels of every plain (not yet LZ4 packed) ENTRY_PIXELS entry no bigger than maxSide
+// either way into pageSize * pageSize atlas pages, and turns the entry into an ENTRY_ATLAS one
+// (see wgfsformat.h). The pages are added as "@atlas/N" entries, cut down to what they use, and
+// everything is sorted by name again since the rects point at pages by index.
+// Placement only depends on the sprites' sizes and names, so it's the same on every run.
+// Returns how many sprites went into how many pages.
+size_t PackAtlas(std::vector<ArchiveEntry>* entries, uint32_t pageSize, uint32_t maxSide, size_t* pages);
+
+#endif // _ATLAS_H_
@@ -0,0 +1,102 @@
+#include <stdio.h>
+
+#include <set>
+
+#include "../common/wgfswriter.h"
+#include "idheader.h"
+
+// upper case, anything that can't be in an identifier becomes '_', taken ones get a number.
+static std::string MakeIdentifier(const std::string& name, std::set<std::string>* taken)
+{
+	std::string id;
+	for (unsigned char c : name) {
+		if (c >= 'a' && c <= 'z') id.push_back((char)(c - 'a' + 'A'));
+		else if ((c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')) id.push_back((char)c);
+		else id.push_back('_');
+	}
+
+	if (id.empty() || (id[0] >= '0' && id[0] <= '9')) id.insert(id.begin(), '_');
+
+	// ALL and the counts are ours.
+	std::string base = id;
+	for (int n = 2; id == "ALL" || !taken->insert(id).second; n++) id = base + "_" + std::to_string(n);
+	return id;
+}
+
+static std::string Quote(const std::string& s)
+{
+	std::string out = "\"";
+	for (unsigned char c : s) {
+		if (c == '"' || c == '\\') {
+			out.push_back('\\');
+			out.push_back((char)c);
+		}
+		else if (c < 0x20 || c >= 0x7F) {
+			char esc[8];
+			snprintf(esc, sizeof(esc), "\\%03o", c);
+			out += esc;
+		}
+		else {
+			out.push_back((char)c);
+		}
+	}
+	return out + "\"";
+}
+
+static void AddGroup(std::string* out, const char* group, const char* count, const std::vector<std::string>& names)
+{
+	std::set<std::string> taken;
+	std::vector<std::string> ids;
+
+	*out += "\tnamespace " + std::string(group) + "\n\t{\n";
+	*out += "\t\tconstexpr uint32_t " + std::string(count) + " = " + std::to_string(names.size()) + ";\n\n";
+
+	for (size_t i = 0; i < names.size(); i++) {
+		char hash[16];
+		snprintf(hash, sizeof(hash), "0x%08X", WGFS::HashName(names[i]));
+
+		ids.push_back(MakeIdentifier(names[i], &taken));
+		*out += "\t\tconstexpr WGFS::AssetId " + ids.back() + " = { " + std::to_string(i) + ", " + hash + ", " + Quote(names[i]) + " };\n";
+	}
+
+	*out += "\n\t\tconstexpr WGFS::AssetId ALL[] = {";
+	for (size_t i = 0; i < ids.size(); i++) *out += (i % 4 == 0 ? "\n\t\t\t" : " ") + ids[i] + ",";
+	if (ids.empty()) *out += "\n\t\t\t{ 0xFFFFFFFF, 0, \"\" }"; // no empty arrays in C++
+	*out += "\n\t\t};\n\t}\n";
+}
+
+std::string MakeIdHeader(const std::vector<std::string>& files, const StringTable& strings)
+{
+	std::vector<std::string> keys;
+	for (auto& kv : strings) keys.push_back(kv.first);
+
+	std::string out =
+		"// Generated by wgfs-packer --ids from assets.json and the asset directory, don't edit.\n"
+		"// Indices match the data.dat packed with it, Assets::GetFileById/GetString fall back to\n"
+		"// the name when they don't.\n"
+		"#ifndef _ASSETIDS_H_\n"
+		"#define _ASSETIDS_H_\n"
+		"\n"
+		"#include \"wgfsformat.h\"\n"
+		"\n"
+		"namespace AssetIds\n"
+		"{\n";
+
+	AddGroup(&out, "Files", "FILE_COUNT", files);
+	out += "\n";
+	AddGroup(&out, "Strings", "STRING_COUNT", keys);
+
+	out +=
+		"}\n"
+		"\n"
+		"#endif // _ASSETIDS_H_\n";
+	return out;
+}
+
+bool WriteIdHeader(const char* path, const std::string& header)
+{
+	std::vector<unsigned char> old;
+	if (ReadWholeFile(path, &old) && std::string(old.begin(), old.end()) == header) return true;
+
+	return WriteWholeFile(path, std::vector<unsigned char>(header.begin(), header.end()));
+}
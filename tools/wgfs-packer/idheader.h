@@ -0,0 +1,17 @@
+#ifndef _IDHEADER_H_
+#define _IDHEADER_H_
+
+#include <string>
+#include <vector>
+
+#include "../common/assetsjson.h"
+
+// The assetids.h the game includes: a WGFS::AssetId for every file (in archive order, so names
+// must already be sorted the way the packer writes them) and every string, under an identifier
+// made from the name ("banana.png" -> Files::BANANA_PNG, "hud_text" -> Strings::HUD_TEXT).
+std::string MakeIdHeader(const std::vector<std::string>& files, const StringTable& strings);
+
+// only touches the file when it would change, so the game isn't rebuilt for nothing.
+bool WriteIdHeader(const char* path, const std::string& header);
+
+#endif // _IDHEADER_H_
@@ -0,0 +1,303 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <thread>
+
+#include "../common/pngdecode.h"
+#include "../common/wgfswriter.h"
+#include "resample.h"
+#include "atlas.h"
+#include "idheader.h"
+#include "packcache.h"
+
+// wgfs-packer - build data.dat from the asset directory and assets.json.
+//
+//   wgfs-packer <assetdir> <assets.json> [out.dat] [--version 2] [--align 64] [--lz4 0.9] [--pixels] [--premultiply] [--threads N] [--cache dir] [--ids assetids.h] [--atlas 2048] [--atlas-max 512] [--fit 1280x640]
+//
+// Every regular file in assetdir becomes an entry named after the file, assets.json becomes the
+// string table. Files are read, decoded and packed on all cores, but entries are always written
+// sorted by name and strings in file order, so the same inputs give the same bytes.
+// The options mean the same as in wgfs-convert, out defaults to data.dat.
+// --cache keeps every processed entry under the hash of its file and the settings, so a rebuild
+// only decodes and compresses the files that changed.
+// --ids writes the header of file and string IDs for this archive, see idheader.h.
+// --atlas packs the decoded sprites up to --atlas-max (a quarter of the page by default) a side
+// into pages that size, see atlas.h. Needs --pixels.
+// --fit scales every decoded sprite to fit the box (Lanczos, keeping its shape) before anything
+// else sees it, the same thing SpriteCache does at load time. Needs --pixels.
+
+static void Usage()
+{
+	fprintf(stderr, "usage: wgfs-packer <assetdir> <assets.json> [out.dat] [--version 1|2] [--align 64] [--lz4 maxratio] [--pixels] [--premultiply] [--threads N] [--cache dir] [--ids assetids.h] [--atlas pagesize] [--atlas-max side] [--fit WxH]\n");
+}
+
+static bool EndsWith(const std::string& s, const char* suffix)
+{
+	size_t n = strlen(suffix);
+	return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 3) {
+		Usage();
+		return 1;
+	}
+
+	const char* assetDir = argv[1];
+	const char* jsonPath = argv[2];
+	const char* outPath = "data.dat";
+	int version = WGFS::VERSION_2;
+	uint32_t alignment = WGFS::V2_DEFAULT_ALIGN;
+	double maxRatio = 0.9;
+	bool pixels = false;
+	bool premultiply = false;
+	int threads = (int)std::thread::hardware_concurrency();
+	std::string cacheDir;
+	const char* idsPath = nullptr;
+	uint32_t atlasPage = 0;
+	uint32_t atlasMax = 0;
+	int fitW = 0;
+	int fitH = 0;
+
+	int i = 3;
+	if (i < argc && strncmp(argv[i], "--", 2) != 0) outPath = argv[i++];
+
+	for (; i < argc; i++) {
+		if (strcmp(argv[i], "--pixels") == 0) {
+			pixels = true;
+			continue;
+		}
+		else if (strcmp(argv[i], "--premultiply") == 0) {
+			premultiply = true;
+			continue;
+		}
+
+		if (i + 1 >= argc) {
+			Usage();
+			return 1;
+		}
+
+		if (strcmp(argv[i], "--version") == 0) {
+			version = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--align") == 0) {
+			alignment = (uint32_t)atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--lz4") == 0) {
+			maxRatio = atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--threads") == 0) {
+			threads = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--cache") == 0) {
+			cacheDir = argv[++i];
+		}
+		else if (strcmp(argv[i], "--ids") == 0) {
+			idsPath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--atlas") == 0) {
+			atlasPage = (uint32_t)atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--atlas-max") == 0) {
+			atlasMax = (uint32_t)atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--fit") == 0) {
+			if (sscanf(argv[++i], "%dx%d", &fitW, &fitH) != 2 || fitW <= 0 || fitH <= 0) {
+				Usage();
+				return 1;
+			}
+		}
+		else {
+			Usage();
+			return 1;
+		}
+	}
+
+	if ((version != (int)WGFS::VERSION_1 && version != (int)WGFS::VERSION_2)
+		|| (pixels && version != (int)WGFS::VERSION_2)
+		|| alignment < WGFS::V2_MIN_ALIGN || (alignment & (alignment - 1)) != 0
+		|| (atlasPage != 0 && !pixels) || atlasPage > 16384
+		|| (fitW != 0 && !pixels)) {
+		Usage();
+		return 1;
+	}
+
+	if (threads < 1) threads = 1;
+	if (atlasMax == 0 || atlasMax > atlasPage) atlasMax = atlasPage / 4;
+
+	auto start = std::chrono::steady_clock::now();
+
+	StringTable strings;
+	std::string error;
+	if (!LoadAssetsJson(jsonPath, &strings, &error)) {
+		fprintf(stderr, "wgfs-packer: %s\n", error.c_str());
+		return 1;
+	}
+
+	// directory order differs between file systems, the name order doesn't.
+	std::vector<std::string> names;
+	std::error_code ec;
+	for (auto& entry : std::filesystem::directory_iterator(assetDir, ec)) {
+		if (entry.is_regular_file()) names.push_back(entry.path().filename().string());
+	}
+
+	if (ec) {
+		fprintf(stderr, "wgfs-packer: unable to list %s: %s\n", assetDir, ec.message().c_str());
+		return 1;
+	}
+
+	std::sort(names.begin(), names.end());
+
+	// each worker takes the next entry until there are none left. entries only ever touch their
+	// own slot, so the results don't depend on which thread got what.
+	std::vector<ArchiveEntry> entries(names.size());
+	std::vector<std::string> errors(names.size());
+	std::vector<std::string> notes(names.size());
+	std::vector<double> times(names.size());
+	std::vector<char> cached(names.size());
+	std::atomic<size_t> next(0);
+
+	// everything that changes what a file turns into. the extension is in there since only
+	// .png files get decoded.
+	char settings[160];
+	snprintf(settings, sizeof(settings), "v%d lz4 %.6f pixels %d premultiply %d atlas %u fit %dx%d", version, maxRatio, (int)pixels, (int)premultiply, atlasMax, fitW, fitH);
+
+	auto work = [&]() {
+		for (size_t e = next++; e < entries.size(); e = next++) {
+			ArchiveEntry* entry = &entries[e];
+			entry->name = names[e];
+
+			std::string path = (std::filesystem::path(assetDir) / names[e]).string();
+			auto fileStart = std::chrono::steady_clock::now();
+			if (!ReadWholeFile(path.c_str(), &entry->data)) {
+				errors[e] = "unable to read " + path;
+				continue;
+			}
+
+			std::string key;
+			uint64_t inputSize = entry->data.size();
+			if (!cacheDir.empty()) {
+				key = PackCacheKey(entry->data, std::string(settings) + " " + std::filesystem::path(names[e]).extension().string());
+				cached[e] = PackCacheLoad(cacheDir, key, inputSize, entry);
+			}
+
+			if (!cached[e]) {
+				if (pixels && EndsWith(entry->name, ".png")) {
+					int w, h;
+					std::vector<uint8_t> rgba;
+
+					if (!DecodePNG(entry->data, &w, &h, &rgba, &errors[e])) continue;
+
+					int scaledW, scaledH;
+					if (fitW != 0) {
+						Resample::FitSize(w, h, fitW, fitH, &scaledW, &scaledH);
+						if (scaledW != w || scaledH != h) {
+							// each byte is filtered on its own, so RGBA goes through as it is.
+							std::vector<uint32_t> src((size_t)w * h), dst((size_t)scaledW * scaledH);
+							memcpy(src.data(), rgba.data(), src.size() * 4);
+							Resample::Pixels(src.data(), w, h, w, dst.data(), scaledW, scaledH, Resample::Filter::LANCZOS3);
+
+							rgba.resize(dst.size() * 4);
+							memcpy(rgba.data(), dst.data(), rgba.size());
+							notes[e] += " scaled " + std::to_string(w) + "x" + std::to_string(h) + " -> " + std::to_string(scaledW) + "x" + std::to_string(scaledH);
+							w = scaledW;
+							h = scaledH;
+						}
+					}
+
+					MakePixelEntry(entry, w, h, rgba, premultiply);
+					notes[e] += " decoded " + std::to_string(w) + "x" + std::to_string(h);
+				}
+
+				// atlas sprites are packed with their page, they need to stay plain until then.
+				bool forAtlas = false;
+				if ((entry->flags & WGFS::ENTRY_PIXELS) && atlasMax != 0) {
+					WGFS::PixelHeader ph;
+					memcpy(&ph, entry->data.data(), sizeof(ph));
+					forAtlas = ph.width <= atlasMax && ph.height <= atlasMax;
+				}
+
+				if (version == (int)WGFS::VERSION_2 && maxRatio > 0 && !forAtlas && PackEntryLZ4(entry, maxRatio))
+					notes[e] += " packed " + std::to_string(entry->rawSize) + " -> " + std::to_string(entry->data.size());
+
+				// a cache that can't be written only makes the next build slower.
+				if (!cacheDir.empty() && !PackCacheStore(cacheDir, key, inputSize, *entry))
+					notes[e] += " (not cached)";
+			}
+			else {
+				notes[e] += " cached";
+			}
+
+			times[e] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - fileStart).count();
+		}
+	};
+
+	int workers = std::min<int>(threads, std::max<size_t>(entries.size(), 1));
+	std::vector<std::thread> pool;
+	for (int t = 1; t < workers; t++) pool.emplace_back(work);
+	work();
+	for (auto& t : pool) t.join();
+
+	size_t decoded = 0;
+	size_t packed = 0;
+	size_t hits = 0;
+	double hitTime = 0;
+	double missTime = 0;
+	for (size_t e = 0; e < entries.size(); e++) {
+		if (!errors[e].empty()) {
+			fprintf(stderr, "wgfs-packer: %s: %s\n", names[e].c_str(), errors[e].c_str());
+			return 1;
+		}
+
+		if (entries[e].flags & WGFS::ENTRY_PIXELS) decoded++;
+		if (entries[e].flags & WGFS::ENTRY_LZ4) packed++;
+		if (cached[e]) hits++;
+		(cached[e] ? hitTime : missTime) += times[e];
+
+		if (!notes[e].empty()) printf("wgfs-packer: %s%s, %.1fms\n", names[e].c_str(), notes[e].c_str(), times[e]);
+	}
+
+	// per-file times add up across threads, they show where the work went rather than the wall clock.
+	if (!cacheDir.empty())
+		printf("wgfs-packer: cache %zu hit(s) in %.1fms, %zu miss(es) in %.1fms\n", hits, hitTime, entries.size() - hits, missTime);
+
+	size_t atlased = 0;
+	size_t pages = 0;
+	if (atlasPage != 0) {
+		atlased = PackAtlas(&entries, atlasPage, atlasMax, &pages);
+
+		names.clear();
+		for (auto& entry : entries) {
+			names.push_back(entry.name);
+			if (entry.name.compare(0, 7, "@atlas/") == 0 && maxRatio > 0 && PackEntryLZ4(&entry, maxRatio))
+				printf("wgfs-packer: %s packed %u -> %zu\n", entry.name.c_str(), entry.rawSize, entry.data.size());
+		}
+
+		printf("wgfs-packer: %zu sprite(s) in %zu atlas page(s)\n", atlased, pages);
+	}
+
+	std::vector<unsigned char> out;
+	if (version == (int)WGFS::VERSION_1) WriteArchiveV1(entries, strings, &out);
+	else WriteArchiveV2(entries, strings, alignment, &out);
+
+	if (!WriteWholeFile(outPath, out)) {
+		fprintf(stderr, "wgfs-packer: unable to write %s\n", outPath);
+		return 1;
+	}
+
+	if (idsPath != nullptr && !WriteIdHeader(idsPath, MakeIdHeader(names, strings))) {
+		fprintf(stderr, "wgfs-packer: unable to write %s\n", idsPath);
+		return 1;
+	}
+
+	long long ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+	printf("wgfs-packer: %zu file(s) (%zu decoded, %zu packed), %zu string(s) -> %s (v%d, %zu bytes) in %lldms on %d thread(s)\n",
+		entries.size(), decoded, packed, strings.size(), outPath, version, out.size(), ms, workers);
+	return 0;
+}
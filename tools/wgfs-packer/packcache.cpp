@@ -0,0 +1,50 @@
+#include <string.h>
+
+#include "packcache.h"
+
+// "WPCE", bumped with PACK_CACHE_VERSION whenever processing changes so old entries are ignored.
+static const uint32_t PACK_CACHE_MAGIC = 1162039383;
+static const uint32_t PACK_CACHE_VERSION = 1;
+
+typedef struct _pack_cache_header {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t flags;     // ArchiveEntry::flags
+	uint32_t rawSize;   // ArchiveEntry::rawSize
+	uint64_t inputSize; // size of the file it was made from, a cheap extra check on the key
+	uint64_t dataSize;
+} PackCacheHeader;
+
+static_assert(sizeof(PackCacheHeader) == 32, "PackCacheHeader must stay 32 bytes");
+
+std::string PackCacheKey(const std::vector<unsigned char>& input, const std::string& settings)
+{
+	CacheKey key((uint64_t)PACK_CACHE_MAGIC << 32 | PACK_CACHE_VERSION);
+	key.Add(settings.data(), settings.size());
+	key.Add(input.data(), input.size());
+	return key.Hex();
+}
+
+bool PackCacheLoad(const std::string& dir, const std::string& key, uint64_t inputSize, ArchiveEntry* entry)
+{
+	CacheFile file;
+	if (!file.Map(CachePath(dir, key, ".wpc"), sizeof(PackCacheHeader))) return false;
+
+	PackCacheHeader h;
+	memcpy(&h, file.GetData(), sizeof(h));
+	if (h.magic != PACK_CACHE_MAGIC || h.version != PACK_CACHE_VERSION || h.inputSize != inputSize
+		|| h.dataSize != file.GetSize() - sizeof(h) || h.dataSize > 0xFFFFFFFFu)
+		return false;
+
+	const unsigned char* data = file.GetData() + sizeof(h);
+	entry->data.assign(data, data + h.dataSize);
+	entry->flags = h.flags;
+	entry->rawSize = h.rawSize;
+	return true;
+}
+
+bool PackCacheStore(const std::string& dir, const std::string& key, uint64_t inputSize, const ArchiveEntry& entry)
+{
+	PackCacheHeader h = { PACK_CACHE_MAGIC, PACK_CACHE_VERSION, entry.flags, entry.rawSize, inputSize, entry.data.size() };
+	return CacheStore(CachePath(dir, key, ".wpc"), &h, sizeof(h), entry.data.data(), entry.data.size());
+}
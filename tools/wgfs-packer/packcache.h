@@ -0,0 +1,24 @@
+#ifndef _PACKCACHE_H_
+#define _PACKCACHE_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "../common/keyedcache.h"
+#include "../common/wgfswriter.h"
+
+// Content-addressed cache of processed entries for wgfs-packer (see keyedcache.h). An entry is
+// keyed on the bytes of the input file plus everything that changes how it's processed, so an
+// untouched file with the same settings comes back as it was packed last time without decoding
+// or compressing it again.
+
+// hex key for the file's bytes processed with settings (anything that affects the output).
+std::string PackCacheKey(const std::vector<unsigned char>& input, const std::string& settings);
+
+// fills entry->data/flags/rawSize from the cache, false when there's nothing (usable) there.
+bool PackCacheLoad(const std::string& dir, const std::string& key, uint64_t inputSize, ArchiveEntry* entry);
+
+bool PackCacheStore(const std::string& dir, const std::string& key, uint64_t inputSize, const ArchiveEntry& entry);
+
+#endif // _PACKCACHE_H_